@@ -11,9 +11,6 @@
 #define PIT_PORT_CONTROL          0x43                /* Control port. */
 #define PIT_PORT_COUNTER(CHANNEL) (0x40 + (CHANNEL))  /* Counter port. */
 
-/* PIT cycles per second. */
-#define PIT_HZ 1193180
-
 /* Configure the given CHANNEL in the PIT.  In a PC, the PIT's
    three output channels are hooked up like this:
 
@@ -81,3 +78,44 @@ pit_configure_channel (int channel, int mode, int frequency)
   outb (PIT_PORT_COUNTER (channel), count >> 8);
   intr_set_level (old_level);
 }
+
+/* Configures CHANNEL in mode 0, "interrupt on terminal count":
+   the channel's output goes to 1 once, COUNT PIT cycles from
+   now, and stays there until the channel is reprogrammed.  On
+   channel 0 this yields a single timer interrupt.  A COUNT of 0
+   is treated as 65536. */
+void
+pit_configure_oneshot (int channel, uint16_t count)
+{
+  enum intr_level old_level;
+
+  ASSERT (channel == 0 || channel == 2);
+
+  old_level = intr_disable ();
+  outb (PIT_PORT_CONTROL, (channel << 6) | 0x30);
+  outb (PIT_PORT_COUNTER (channel), count);
+  outb (PIT_PORT_COUNTER (channel), count >> 8);
+  intr_set_level (old_level);
+}
+
+/* Returns the number of PIT cycles left before CHANNEL's count
+   reaches zero.  In mode 0 the count keeps going down past zero,
+   wrapping around to 65535. */
+uint16_t
+pit_read_count (int channel)
+{
+  enum intr_level old_level;
+  uint16_t count;
+
+  ASSERT (channel == 0 || channel == 2);
+
+  /* Latch the counter, so that the two bytes read belong to the
+     same value. */
+  old_level = intr_disable ();
+  outb (PIT_PORT_CONTROL, channel << 6);
+  count = inb (PIT_PORT_COUNTER (channel));
+  count |= inb (PIT_PORT_COUNTER (channel)) << 8;
+  intr_set_level (old_level);
+
+  return count;
+}
@@ -5,6 +5,7 @@
 #include "devices/serial.h"
 #include "devices/timer.h"
 #include "threads/io.h"
+#include "threads/interrupt.h"
 #include "threads/thread.h"
 #ifdef USERPROG
 #include "userprog/exception.h"
@@ -13,6 +14,9 @@
 #include "devices/block.h"
 #include "filesys/filesys.h"
 #endif
+#ifdef VM
+#include "vm/page.h"
+#endif
 
 /* Keyboard control register port. */
 #define CONTROL_REG 0x64
@@ -123,6 +127,7 @@ print_stats (void)
 {
   timer_print_stats ();
   thread_print_stats ();
+  intr_print_stats ();
 #ifdef FILESYS
   block_print_stats ();
 #endif
@@ -131,4 +136,7 @@ print_stats (void)
 #ifdef USERPROG
   exception_print_stats ();
 #endif
+#ifdef VM
+  print_page_stats ();
+#endif
 }
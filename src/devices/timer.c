@@ -4,7 +4,9 @@
 #include <round.h>
 #include <stdio.h>
 #include "devices/pit.h"
+#include "threads/cpu.h"
 #include "threads/interrupt.h"
+#include "threads/io.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
   
@@ -20,15 +22,43 @@
 /* Number of timer ticks since OS booted. */
 static int64_t ticks;
 
-/* Number of loops per timer tick.
-   Initialized by timer_calibrate(). */
-static unsigned loops_per_tick;
+/* PIT cycles in one timer tick. */
+#define TICK_COUNT ((PIT_HZ + TIMER_FREQ / 2) / TIMER_FREQ)
+
+/* Longest one-shot the 16-bit PIT counter can express, in ticks. */
+#define ONESHOT_MAX_TICKS (65535 / TICK_COUNT)
+
+/* If false (default), the timer interrupts every tick.
+   If true, the idle thread switches the timer to one-shot mode
+   until the next event it has to wake up for.
+   Controlled by kernel command-line option "-tickless". */
+bool timer_tickless;
+
+/* Ticks covered by the armed one-shot, or 0 if the timer is in
+   periodic mode. */
+static int64_t oneshot_ticks;
+
+/* Ticks that passed without a timer interrupt. */
+static long long saved_ticks;
+
+/* Time-stamp counter frequency, in cycles per second, and its
+   value at timer_init().  tsc_hz is measured by timer_calibrate()
+   and is 0 before that. */
+static uint64_t tsc_hz;
+static uint64_t tsc_boot;
+
+/* PIT cycles over which timer_calibrate() counts TSC cycles:
+   10 ms' worth. */
+#define CALIBRATE_PIT_CYCLES (PIT_HZ / 100)
+
+/* PC speaker gate register.  Bit 0 gates PIT channel 2, bit 1
+   connects its output to the speaker. */
+#define SPEAKER_PORT_GATE 0x61
 
 static intr_handler_func timer_interrupt;
-static bool too_many_loops (unsigned loops);
-static void busy_wait (int64_t loops);
 static void real_time_sleep (int64_t num, int32_t denom);
 static void real_time_delay (int64_t num, int32_t denom);
+static void tsc_delay (uint64_t start, int64_t num, int32_t denom);
 
 /* Sets up the timer to interrupt TIMER_FREQ times per second,
    and registers the corresponding interrupt. */
@@ -37,33 +67,68 @@ timer_init (void)
 {
   pit_configure_channel (0, 2, TIMER_FREQ);
   intr_register_ext (0x20, timer_interrupt, "8254 Timer");
+  tsc_boot = rdtsc ();
 }
 
-/* Calibrates loops_per_tick, used to implement brief delays. */
+/* Measures the frequency of the time-stamp counter, which
+   timer_now_ns() and the brief delays are based on, by counting
+   TSC cycles while PIT channel 2 counts down a known number of
+   PIT cycles.  Channel 0 is left alone, so the timer interrupt is
+   not disturbed, and the measurement takes only about 10 ms. */
 void
 timer_calibrate (void) 
 {
-  unsigned high_bit, test_bit;
+  enum intr_level old_level;
+  uint64_t start_tsc, end_tsc;
+  uint16_t start_count;
+  uint8_t gate;
 
-  ASSERT (intr_get_level () == INTR_ON);
   printf ("Calibrating timer...  ");
 
-  /* Approximate loops_per_tick as the largest power-of-two
-     still less than one timer tick. */
-  loops_per_tick = 1u << 10;
-  while (!too_many_loops (loops_per_tick << 1)) 
-    {
-      loops_per_tick <<= 1;
-      ASSERT (loops_per_tick != 0);
-    }
+  old_level = intr_disable ();
+
+  /* Let channel 2 count, without driving the speaker, and start
+     it counting down from 65535. */
+  gate = inb (SPEAKER_PORT_GATE);
+  outb (SPEAKER_PORT_GATE, (gate & ~0x02) | 0x01);
+  pit_configure_oneshot (2, 0xffff);
+
+  start_count = pit_read_count (2);
+  start_tsc = rdtsc ();
+  while (start_count - pit_read_count (2) < CALIBRATE_PIT_CYCLES)
+    continue;
+  end_tsc = rdtsc ();
 
-  /* Refine the next 8 bits of loops_per_tick. */
-  high_bit = loops_per_tick;
-  for (test_bit = high_bit >> 1; test_bit != high_bit >> 10; test_bit >>= 1)
-    if (!too_many_loops (high_bit | test_bit))
-      loops_per_tick |= test_bit;
+  outb (SPEAKER_PORT_GATE, gate);
+  intr_set_level (old_level);
 
-  printf ("%'"PRIu64" loops/s.\n", (uint64_t) loops_per_tick * TIMER_FREQ);
+  tsc_hz = (end_tsc - start_tsc) * PIT_HZ / CALIBRATE_PIT_CYCLES;
+  printf ("%'"PRIu64" TSC cycles/s.\n", tsc_hz);
+}
+
+/* Returns the number of nanoseconds since timer_init(), as
+   measured by the time-stamp counter, or 0 if the timer has not
+   yet been calibrated. */
+uint64_t
+timer_now_ns (void) 
+{
+  uint64_t cycles = rdtsc () - tsc_boot;
+
+  if (tsc_hz == 0)
+    return 0;
+
+  /* Split the conversion so that cycles * 10**9 cannot
+     overflow. */
+  return (cycles / tsc_hz * 1000000000
+          + cycles % tsc_hz * 1000000000 / tsc_hz);
+}
+
+/* Returns the number of time-stamp counter cycles per second, or
+   0 if the timer has not yet been calibrated. */
+uint64_t
+timer_tsc_hz (void) 
+{
+  return tsc_hz;
 }
 
 /* Returns the number of timer ticks since the OS booted. */
@@ -102,6 +167,65 @@ timer_sleep (int64_t ticks)
   thread_sleep(start + ticks);
 }
 
+/* Called by the idle thread, with interrupts off, just before
+   it halts the CPU.  In tickless mode, stops the periodic timer
+   and arms a one-shot interrupt for tick NEXT, the earliest tick
+   anything is waiting for, or as close to it as the PIT can
+   count. */
+void
+timer_idle_enter (int64_t next) 
+{
+  int64_t n;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (!timer_tickless || oneshot_ticks != 0)
+    return;
+
+  n = next - ticks;
+  if (n > ONESHOT_MAX_TICKS)
+    n = ONESHOT_MAX_TICKS;
+
+  /* Not worth it: the periodic interrupt comes as soon. */
+  if (n < 2)
+    return;
+
+  pit_configure_oneshot (0, n * TICK_COUNT);
+  oneshot_ticks = n;
+}
+
+/* Called with interrupts off when the idle thread wakes up from
+   a halt and whenever the CPU switches away from the idle
+   thread.  If some interrupt other than the one-shot woke the
+   CPU, accounts for the whole ticks that have passed, wakes the
+   threads that came due in them, and puts the timer back in
+   periodic mode. */
+void
+timer_idle_exit (void) 
+{
+  uint32_t programmed, left, elapsed;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (oneshot_ticks == 0)
+    return;
+
+  /* If the count has run out, or is about to, the one-shot
+     interrupt is pending and timer_interrupt() will take care of
+     it as soon as interrupts are back on. */
+  programmed = oneshot_ticks * TICK_COUNT;
+  left = pit_read_count (0);
+  if (left > programmed || left < TICK_COUNT / 8)
+    return;
+
+  elapsed = (programmed - left) / TICK_COUNT;
+  ticks += elapsed;
+  saved_ticks += elapsed;
+  oneshot_ticks = 0;
+  pit_configure_channel (0, 2, TIMER_FREQ);
+  thread_wake_sleepers (ticks);
+}
+
 /* Sleeps for approximately MS milliseconds.  Interrupts must be
    turned on. */
 void
@@ -170,49 +294,29 @@ void
 timer_print_stats (void) 
 {
   printf ("Timer: %"PRId64" ticks\n", timer_ticks ());
+  if (timer_tickless)
+    printf ("Timer: %lld interrupts saved by tickless idle\n",
+            saved_ticks);
 }
 
 /* Timer interrupt handler. */
 static void
 timer_interrupt (struct intr_frame *args UNUSED)
 {
-  ticks++;
+  if (oneshot_ticks != 0)
+    {
+      /* End of a tickless idle period: catch up and go back to
+         periodic mode. */
+      ticks += oneshot_ticks;
+      saved_ticks += oneshot_ticks - 1;
+      oneshot_ticks = 0;
+      pit_configure_channel (0, 2, TIMER_FREQ);
+    }
+  else
+    ticks++;
   thread_tick ();
 }
 
-/* Returns true if LOOPS iterations waits for more than one timer
-   tick, otherwise false. */
-static bool
-too_many_loops (unsigned loops) 
-{
-  /* Wait for a timer tick. */
-  int64_t start = ticks;
-  while (ticks == start)
-    barrier ();
-
-  /* Run LOOPS loops. */
-  start = ticks;
-  busy_wait (loops);
-
-  /* If the tick count changed, we iterated too long. */
-  barrier ();
-  return start != ticks;
-}
-
-/* Iterates through a simple loop LOOPS times, for implementing
-   brief delays.
-
-   Marked NO_INLINE because code alignment can significantly
-   affect timings, so that if this function was inlined
-   differently in different places the results would be difficult
-   to predict. */
-static void NO_INLINE
-busy_wait (int64_t loops) 
-{
-  while (loops-- > 0)
-    barrier ();
-}
-
 /* Sleep for approximately NUM/DENOM seconds. */
 static void
 real_time_sleep (int64_t num, int32_t denom) 
@@ -224,6 +328,7 @@ real_time_sleep (int64_t num, int32_t denom)
      1 s / TIMER_FREQ ticks
   */
   int64_t ticks = num * TIMER_FREQ / denom;
+  uint64_t start = rdtsc ();
 
   ASSERT (intr_get_level () == INTR_ON);
   if (ticks > 0)
@@ -233,20 +338,38 @@ real_time_sleep (int64_t num, int32_t denom)
          processes. */                
       timer_sleep (ticks); 
     }
-  else 
-    {
-      /* Otherwise, use a busy-wait loop for more accurate
-         sub-tick timing. */
-      real_time_delay (num, denom); 
-    }
+
+  /* timer_sleep() wakes on a tick boundary, so it can return up
+     to a tick early, and the conversion above dropped any
+     fraction of a tick.  Busy-wait the rest on the time-stamp
+     counter, for sub-tick precision. */
+  tsc_delay (start, num, denom);
 }
 
-/* Busy-wait for approximately NUM/DENOM seconds. */
+/* Busy-wait for approximately NUM/DENOM seconds, by watching
+   the time-stamp counter.  Interrupts taken during the wait count
+   toward it, instead of stretching it as they would a loop of
+   fixed length. */
 static void
 real_time_delay (int64_t num, int32_t denom)
 {
-  /* Scale the numerator and denominator down by 1000 to avoid
-     the possibility of overflow. */
-  ASSERT (denom % 1000 == 0);
-  busy_wait (loops_per_tick * num / 1000 * TIMER_FREQ / (denom / 1000)); 
+  tsc_delay (rdtsc (), num, denom);
+}
+
+/* Busy-waits until NUM/DENOM seconds have passed since the
+   time-stamp counter read START. */
+static void
+tsc_delay (uint64_t start, int64_t num, int32_t denom)
+{
+  uint64_t cycles;
+
+  ASSERT (denom > 0);
+  if (num <= 0)
+    return;
+
+  /* Split the conversion so that num * tsc_hz cannot
+     overflow. */
+  cycles = num / denom * tsc_hz + num % denom * tsc_hz / denom;
+  while (rdtsc () - start < cycles)
+    barrier ();
 }
@@ -2,16 +2,22 @@
 #define DEVICES_TIMER_H
 
 #include <round.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 /* Number of timer interrupts per second. */
 #define TIMER_FREQ 100
 
+/* Tickless idle mode, set by "-tickless". */
+extern bool timer_tickless;
+
 void timer_init (void);
 void timer_calibrate (void);
 
 int64_t timer_ticks (void);
 int64_t timer_elapsed (int64_t);
+uint64_t timer_now_ns (void);
+uint64_t timer_tsc_hz (void);
 
 /* Sleep and yield the CPU to other threads. */
 void timer_sleep (int64_t ticks);
@@ -24,6 +30,10 @@ void timer_mdelay (int64_t milliseconds);
 void timer_udelay (int64_t microseconds);
 void timer_ndelay (int64_t nanoseconds);
 
+/* Tickless idle. */
+void timer_idle_enter (int64_t next);
+void timer_idle_exit (void);
+
 void timer_print_stats (void);
 
 #endif /* devices/timer.h */
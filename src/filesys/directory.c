@@ -5,6 +5,7 @@
 #include "filesys/filesys.h"
 #include "filesys/inode.h"
 #include "threads/malloc.h"
+#include "threads/synch.h"
 
 /* A directory. */
 struct dir 
@@ -21,6 +22,19 @@ struct dir_entry
     bool in_use;                        /* In use or free? */
   };
 
+/* Serializes changes to directory contents against each other
+   and against lookups, so that dir_add() cannot hand out a slot
+   that a concurrent dir_add() also found free.  The file system
+   has only the root directory, so one lock covers them all. */
+static struct rwlock dir_lock;
+
+/* Initializes the directory module. */
+void
+dir_init (void) 
+{
+  rwlock_init (&dir_lock);
+}
+
 /* Creates a directory with space for ENTRY_CNT entries in the
    given SECTOR.  Returns true if successful, false on failure. */
 bool
@@ -124,10 +138,12 @@ dir_lookup (const struct dir *dir, const char *name,
   ASSERT (dir != NULL);
   ASSERT (name != NULL);
 
+  rwlock_acquire_shared (&dir_lock);
   if (lookup (dir, name, &e, NULL))
     *inode = inode_open (e.inode_sector);
   else
     *inode = NULL;
+  rwlock_release_shared (&dir_lock);
 
   return *inode != NULL;
 }
@@ -152,6 +168,8 @@ dir_add (struct dir *dir, const char *name, block_sector_t inode_sector)
   if (*name == '\0' || strlen (name) > NAME_MAX)
     return false;
 
+  rwlock_acquire_exclusive (&dir_lock);
+
   /* Check that NAME is not in use. */
   if (lookup (dir, name, NULL, NULL))
     goto done;
@@ -175,6 +193,7 @@ dir_add (struct dir *dir, const char *name, block_sector_t inode_sector)
   success = inode_write_at (dir->inode, &e, sizeof e, ofs) == sizeof e;
 
  done:
+  rwlock_release_exclusive (&dir_lock);
   return success;
 }
 
@@ -192,6 +211,8 @@ dir_remove (struct dir *dir, const char *name)
   ASSERT (dir != NULL);
   ASSERT (name != NULL);
 
+  rwlock_acquire_exclusive (&dir_lock);
+
   /* Find directory entry. */
   if (!lookup (dir, name, &e, &ofs))
     goto done;
@@ -211,6 +232,7 @@ dir_remove (struct dir *dir, const char *name)
   success = true;
 
  done:
+  rwlock_release_exclusive (&dir_lock);
   inode_close (inode);
   return success;
 }
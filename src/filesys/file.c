@@ -2,13 +2,16 @@
 #include <debug.h>
 #include "filesys/inode.h"
 #include "threads/malloc.h"
+#include "threads/synch.h"
 
 /* An open file. */
 struct file 
   {
     struct inode *inode;        /* File's inode. */
+    struct lock pos_lock;       /* Guards pos. */
     off_t pos;                  /* Current position. */
     bool deny_write;            /* Has file_deny_write() been called? */
+    int open_cnt;               /* Number of openers, see file_dup(). */
   };
 
 /* Opens a file for the given INODE, of which it takes ownership,
@@ -21,8 +24,10 @@ file_open (struct inode *inode)
   if (inode != NULL && file != NULL)
     {
       file->inode = inode;
+      lock_init (&file->pos_lock);
       file->pos = 0;
       file->deny_write = false;
+      file->open_cnt = 1;
       return file;
     }
   else
@@ -41,11 +46,21 @@ file_reopen (struct file *file)
   return file_open (inode_reopen (file->inode));
 }
 
+/* Returns FILE itself, as an additional opener.  Unlike
+   file_reopen(), the result shares FILE's position.  FILE is
+   not freed until each opener has called file_close(). */
+struct file *
+file_dup (struct file *file) 
+{
+  file->open_cnt++;
+  return file;
+}
+
 /* Closes FILE. */
 void
 file_close (struct file *file) 
 {
-  if (file != NULL)
+  if (file != NULL && --file->open_cnt == 0)
     {
       file_allow_write (file);
       inode_close (file->inode);
@@ -68,8 +83,12 @@ file_get_inode (struct file *file)
 off_t
 file_read (struct file *file, void *buffer, off_t size) 
 {
-  off_t readed_bytes = inode_read_at (file->inode, buffer, size, file->pos);
+  off_t readed_bytes;
+
+  lock_acquire (&file->pos_lock);
+  readed_bytes = inode_read_at (file->inode, buffer, size, file->pos);
   file->pos += readed_bytes;
+  lock_release (&file->pos_lock);
   return readed_bytes;
 }
 
@@ -94,8 +113,12 @@ file_read_at (struct file *file, void *buffer, off_t size, off_t file_ofs)
 off_t
 file_write (struct file *file, const void *buffer, off_t size) 
 {
-  off_t bytes_written = inode_write_at (file->inode, buffer, size, file->pos);
+  off_t bytes_written;
+
+  lock_acquire (&file->pos_lock);
+  bytes_written = inode_write_at (file->inode, buffer, size, file->pos);
   file->pos += bytes_written;
+  lock_release (&file->pos_lock);
   return bytes_written;
 }
 
@@ -155,7 +178,9 @@ file_seek (struct file *file, off_t new_pos)
 {
   ASSERT (file != NULL);
   ASSERT (new_pos >= 0);
+  lock_acquire (&file->pos_lock);
   file->pos = new_pos;
+  lock_release (&file->pos_lock);
 }
 
 /* Returns the current position in FILE as a byte offset from the
@@ -163,6 +188,11 @@ file_seek (struct file *file, off_t new_pos)
 off_t
 file_tell (struct file *file) 
 {
+  off_t pos;
+
   ASSERT (file != NULL);
-  return file->pos;
+  lock_acquire (&file->pos_lock);
+  pos = file->pos;
+  lock_release (&file->pos_lock);
+  return pos;
 }
@@ -6,6 +6,7 @@
 #include "filesys/filesys.h"
 #include "filesys/free-map.h"
 #include "threads/malloc.h"
+#include "threads/synch.h"
 
 /* Identifies an inode. */
 #define INODE_MAGIC 0x494e4f44
@@ -28,7 +29,12 @@ bytes_to_sectors (off_t size)
   return DIV_ROUND_UP (size, BLOCK_SECTOR_SIZE);
 }
 
-/* In-memory inode. */
+/* In-memory inode.
+
+   ELEM, OPEN_CNT and REMOVED are protected by open_inodes_lock.
+   RWLOCK protects the file's data and DENY_WRITE_CNT: readers
+   hold it shared, so reads of one file proceed in parallel,
+   while writers and inode_deny_write() hold it exclusive. */
 struct inode 
   {
     struct list_elem elem;              /* Element in inode list. */
@@ -36,6 +42,7 @@ struct inode
     int open_cnt;                       /* Number of openers. */
     bool removed;                       /* True if deleted, false otherwise. */
     int deny_write_cnt;                 /* 0: writes ok, >0: deny writes. */
+    struct rwlock rwlock;               /* Guards data and deny_write_cnt. */
     struct inode_disk data;             /* Inode content. */
   };
 
@@ -57,11 +64,15 @@ byte_to_sector (const struct inode *inode, off_t pos)
    returns the same `struct inode'. */
 static struct list open_inodes;
 
+/* Protects open_inodes and each inode's open_cnt and removed. */
+static struct lock open_inodes_lock;
+
 /* Initializes the inode module. */
 void
 inode_init (void) 
 {
   list_init (&open_inodes);
+  lock_init (&open_inodes_lock);
 }
 
 /* Initializes an inode with LENGTH bytes of data and
@@ -114,6 +125,8 @@ inode_open (block_sector_t sector)
   struct list_elem *e;
   struct inode *inode;
 
+  lock_acquire (&open_inodes_lock);
+
   /* Check whether this inode is already open. */
   for (e = list_begin (&open_inodes); e != list_end (&open_inodes);
        e = list_next (e)) 
@@ -121,7 +134,8 @@ inode_open (block_sector_t sector)
       inode = list_entry (e, struct inode, elem);
       if (inode->sector == sector) 
         {
-          inode_reopen (inode);
+          inode->open_cnt++;
+          lock_release (&open_inodes_lock);
           return inode; 
         }
     }
@@ -129,15 +143,22 @@ inode_open (block_sector_t sector)
   /* Allocate memory. */
   inode = malloc (sizeof *inode);
   if (inode == NULL)
-    return NULL;
+    {
+      lock_release (&open_inodes_lock);
+      return NULL;
+    }
 
-  /* Initialize. */
+  /* Initialize.  The sector is read with open_inodes_lock still
+     held, so that a concurrent opener of the same sector cannot
+     find the inode before its data is valid. */
   list_push_front (&open_inodes, &inode->elem);
   inode->sector = sector;
   inode->open_cnt = 1;
   inode->deny_write_cnt = 0;
   inode->removed = false;
+  rwlock_init (&inode->rwlock);
   block_read (fs_device, inode->sector, &inode->data);
+  lock_release (&open_inodes_lock);
   return inode;
 }
 
@@ -146,7 +167,11 @@ struct inode *
 inode_reopen (struct inode *inode)
 {
   if (inode != NULL)
-    inode->open_cnt++;
+    {
+      lock_acquire (&open_inodes_lock);
+      inode->open_cnt++;
+      lock_release (&open_inodes_lock);
+    }
   return inode;
 }
 
@@ -168,10 +193,14 @@ inode_close (struct inode *inode)
     return;
 
   /* Release resources if this was the last opener. */
+  lock_acquire (&open_inodes_lock);
   if (--inode->open_cnt == 0)
     {
-      /* Remove from inode list and release lock. */
+      /* Remove from inode list and release lock.  Nobody else can
+         reach INODE after this, so the free map can be updated
+         without holding open_inodes_lock. */
       list_remove (&inode->elem);
+      lock_release (&open_inodes_lock);
  
       /* Deallocate blocks if removed. */
       if (inode->removed) 
@@ -183,6 +212,8 @@ inode_close (struct inode *inode)
 
       free (inode); 
     }
+  else
+    lock_release (&open_inodes_lock);
 }
 
 /* Marks INODE to be deleted when it is closed by the last caller who
@@ -191,7 +222,9 @@ void
 inode_remove (struct inode *inode) 
 {
   ASSERT (inode != NULL);
+  lock_acquire (&open_inodes_lock);
   inode->removed = true;
+  lock_release (&open_inodes_lock);
 }
 
 /* Reads SIZE bytes from INODE into BUFFER, starting at position OFFSET.
@@ -204,6 +237,7 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset)
   off_t bytes_read = 0;
   uint8_t *bounce = NULL;
 
+  rwlock_acquire_shared (&inode->rwlock);
   while (size > 0) 
     {
       /* Disk sector to read, starting byte offset within sector. */
@@ -244,6 +278,7 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset)
       offset += chunk_size;
       bytes_read += chunk_size;
     }
+  rwlock_release_shared (&inode->rwlock);
   free (bounce);
 
   return bytes_read;
@@ -262,8 +297,12 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
   off_t bytes_written = 0;
   uint8_t *bounce = NULL;
 
+  rwlock_acquire_exclusive (&inode->rwlock);
   if (inode->deny_write_cnt)
-    return 0;
+    {
+      rwlock_release_exclusive (&inode->rwlock);
+      return 0;
+    }
 
   while (size > 0) 
     {
@@ -312,6 +351,7 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
       offset += chunk_size;
       bytes_written += chunk_size;
     }
+  rwlock_release_exclusive (&inode->rwlock);
   free (bounce);
 
   return bytes_written;
@@ -322,8 +362,10 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
 void
 inode_deny_write (struct inode *inode) 
 {
+  rwlock_acquire_exclusive (&inode->rwlock);
   inode->deny_write_cnt++;
   ASSERT (inode->deny_write_cnt <= inode->open_cnt);
+  rwlock_release_exclusive (&inode->rwlock);
 }
 
 /* Re-enables writes to INODE.
@@ -332,9 +374,11 @@ inode_deny_write (struct inode *inode)
 void
 inode_allow_write (struct inode *inode) 
 {
+  rwlock_acquire_exclusive (&inode->rwlock);
   ASSERT (inode->deny_write_cnt > 0);
   ASSERT (inode->deny_write_cnt <= inode->open_cnt);
   inode->deny_write_cnt--;
+  rwlock_release_exclusive (&inode->rwlock);
 }
 
 /* Returns the length, in bytes, of INODE's data. */
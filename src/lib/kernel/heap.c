@@ -0,0 +1,160 @@
+/* Priority queue.
+
+   See heap.h for basic information. */
+
+#include "heap.h"
+#include "../debug.h"
+
+static struct heap_elem *merge (struct heap *,
+                                struct heap_elem *, struct heap_elem *);
+
+/* Returns the rank of E, which is 0 for a null pointer. */
+static inline int
+rank (const struct heap_elem *e) 
+{
+  return e != NULL ? e->rank : 0;
+}
+
+/* Swaps E's children if needed so that its right spine is no
+   longer than its left, then recomputes E's rank. */
+static inline void
+fix (struct heap_elem *e) 
+{
+  if (rank (e->left) < rank (e->right))
+    {
+      struct heap_elem *t = e->left;
+      e->left = e->right;
+      e->right = t;
+    }
+  e->rank = rank (e->right) + 1;
+}
+
+/* Initializes heap H as an empty heap ordered by LESS given
+   auxiliary data AUX. */
+void
+heap_init (struct heap *h, heap_less_func *less, void *aux) 
+{
+  ASSERT (h != NULL);
+  ASSERT (less != NULL);
+
+  h->root = NULL;
+  h->size = 0;
+  h->less = less;
+  h->aux = aux;
+}
+
+/* Inserts E into heap H. */
+void
+heap_push (struct heap *h, struct heap_elem *e) 
+{
+  ASSERT (h != NULL);
+  ASSERT (e != NULL);
+
+  e->parent = e->left = e->right = NULL;
+  e->rank = 1;
+  h->root = merge (h, h->root, e);
+  h->root->parent = NULL;
+  h->size++;
+}
+
+/* Removes and returns the minimum element of heap H, which must
+   not be empty. */
+struct heap_elem *
+heap_pop (struct heap *h) 
+{
+  struct heap_elem *e = heap_min (h);
+
+  heap_remove (h, e);
+  return e;
+}
+
+/* Removes E, which must be in heap H, from H. */
+void
+heap_remove (struct heap *h, struct heap_elem *e) 
+{
+  struct heap_elem *parent, *m;
+
+  ASSERT (h != NULL);
+  ASSERT (e != NULL);
+  ASSERT (h->size > 0);
+
+  parent = e->parent;
+  m = merge (h, e->left, e->right);
+  if (m != NULL)
+    m->parent = parent;
+
+  if (parent == NULL)
+    {
+      ASSERT (h->root == e);
+      h->root = m;
+    }
+  else
+    {
+      if (parent->left == e)
+        parent->left = m;
+      else
+        parent->right = m;
+
+      /* Restore the leftist property above E.  Once a rank
+         stops changing, the ranks above it stay as they were. */
+      for (; parent != NULL; parent = parent->parent)
+        {
+          int old_rank = parent->rank;
+          fix (parent);
+          if (parent->rank == old_rank)
+            break;
+        }
+    }
+  e->parent = e->left = e->right = NULL;
+  h->size--;
+}
+
+/* Returns the minimum element of heap H, which must not be
+   empty. */
+struct heap_elem *
+heap_min (struct heap *h) 
+{
+  ASSERT (h != NULL);
+  ASSERT (h->root != NULL);
+
+  return h->root;
+}
+
+/* Returns the number of elements in heap H. */
+size_t
+heap_size (struct heap *h) 
+{
+  ASSERT (h != NULL);
+  return h->size;
+}
+
+/* Returns true if heap H is empty, false otherwise. */
+bool
+heap_empty (struct heap *h) 
+{
+  ASSERT (h != NULL);
+  return h->root == NULL;
+}
+
+/* Merges the subtrees rooted at A and B, either of which may be
+   null, and returns the root of the result.  The recursion only
+   follows right spines, so its depth is O(log N). */
+static struct heap_elem *
+merge (struct heap *h, struct heap_elem *a, struct heap_elem *b) 
+{
+  if (a == NULL)
+    return b;
+  if (b == NULL)
+    return a;
+  if (h->less (b, a, h->aux))
+    {
+      struct heap_elem *t = a;
+      a = b;
+      b = t;
+    }
+
+  a->right = merge (h, a->right, b);
+  a->right->parent = a;
+  fix (a);
+  return a;
+}
@@ -0,0 +1,72 @@
+#ifndef __LIB_KERNEL_HEAP_H
+#define __LIB_KERNEL_HEAP_H
+
+/* Priority queue.
+
+   This is a leftist heap: a binary tree in which every element
+   is no greater than its children, and in which the shortest
+   path to a missing child is always down the right side.  That
+   path therefore has at most log2(N+1) elements, and two heaps
+   are merged by walking down their right sides, so insertion,
+   removal of the minimum, and removal of an arbitrary element
+   all take O(log N) time.
+
+   Like the linked list and hash table implementations, the heap
+   does not use dynamic allocation.  Each structure that can be
+   in a heap must embed a struct heap_elem member, and the
+   heap_entry macro converts a struct heap_elem back to the
+   structure that contains it.  Refer to lib/kernel/list.h for a
+   detailed explanation of the technique.
+
+   Elements that compare equal come out in no particular order.
+   Clients that need FIFO order among equals should break ties
+   with a sequence number in their comparison function. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Heap element. */
+struct heap_elem 
+  {
+    struct heap_elem *parent;   /* Parent, or null at the root. */
+    struct heap_elem *left;     /* Left child. */
+    struct heap_elem *right;    /* Right child. */
+    int rank;                   /* Length of the right spine. */
+  };
+
+/* Converts pointer to heap element HEAP_ELEM into a pointer to
+   the structure that HEAP_ELEM is embedded inside.  Supply the
+   name of the outer structure STRUCT and the member name MEMBER
+   of the heap element. */
+#define heap_entry(HEAP_ELEM, STRUCT, MEMBER)           \
+        ((STRUCT *) ((uint8_t *) &(HEAP_ELEM)->left     \
+                     - offsetof (STRUCT, MEMBER.left)))
+
+/* Compares the value of two heap elements A and B, given
+   auxiliary data AUX.  Returns true if A is less than B, or
+   false if A is greater than or equal to B. */
+typedef bool heap_less_func (const struct heap_elem *a,
+                             const struct heap_elem *b,
+                             void *aux);
+
+/* Heap. */
+struct heap 
+  {
+    struct heap_elem *root;     /* Minimum element. */
+    size_t size;                /* Number of elements. */
+    heap_less_func *less;       /* Comparison function. */
+    void *aux;                  /* Auxiliary data for `less'. */
+  };
+
+void heap_init (struct heap *, heap_less_func *, void *aux);
+
+void heap_push (struct heap *, struct heap_elem *);
+struct heap_elem *heap_pop (struct heap *);
+void heap_remove (struct heap *, struct heap_elem *);
+
+struct heap_elem *heap_min (struct heap *);
+size_t heap_size (struct heap *);
+bool heap_empty (struct heap *);
+
+#endif /* lib/kernel/heap.h */
@@ -20,6 +20,18 @@ enum
     SYS_CLOSE,                  /* Close a file. */
 	SYS_FIB,                    /* Get n-th fibonacci number. */
 	SYS_SUMFOUR,                /* Get sum of four integers. */
+	SYS_TICKETS,                /* Set stride scheduler tickets. */
+	SYS_FUTEX_WAIT,             /* Sleep if a word holds a value. */
+	SYS_FUTEX_WAKE,             /* Wake threads sleeping on a word. */
+	SYS_DUP,                    /* Duplicate a file descriptor. */
+	SYS_DUP2,                   /* Duplicate onto a given descriptor. */
+	SYS_PREAD,                  /* Read from a file at an offset. */
+	SYS_PWRITE,                 /* Write to a file at an offset. */
+	SYS_READV,                  /* Read from a file into several buffers. */
+	SYS_WRITEV,                 /* Write to a file from several buffers. */
+	SYS_RING_SETUP,             /* Register a submission/completion ring. */
+	SYS_RING_ENTER,             /* Carry out submitted ring entries. */
+	SYS_WAITPID,                /* Wait for a child, maybe not blocking. */
 
     /* Project 3 and optionally project 4. */
     SYS_MMAP,                   /* Map a file into memory. */
@@ -0,0 +1,40 @@
+#include "kinfo.h"
+
+/* Optimization barrier, as in the kernel's threads/synch.h. */
+#define barrier() asm volatile ("" : : : "memory")
+
+/* Copies the kernel info page into *INFO.  Retries if the kernel
+   updated the page while it was being copied, so the fields of
+   *INFO are always consistent with each other. */
+void
+kinfo_read (struct kinfo *info) 
+{
+  const volatile struct kinfo *k = KINFO_ADDR;
+  uint32_t seq;
+
+  do
+    {
+      while ((seq = k->seq) & 1)
+        continue;
+      barrier ();
+      info->ticks = k->ticks;
+      info->tsc_hz = k->tsc_hz;
+      info->run_ticks = k->run_ticks;
+      info->page_faults = k->page_faults;
+      barrier ();
+    }
+  while (k->seq != seq);
+  info->seq = seq;
+  info->unused = 0;
+}
+
+/* Returns the number of timer ticks since the OS booted, like
+   the kernel's timer_ticks(). */
+int64_t
+kinfo_ticks (void) 
+{
+  struct kinfo info;
+
+  kinfo_read (&info);
+  return info.ticks;
+}
@@ -0,0 +1,35 @@
+#ifndef __LIB_USER_KINFO_H
+#define __LIB_USER_KINFO_H
+
+#include <stdint.h>
+
+/* Kernel info page.
+
+   The kernel maps one page, read-only, at KINFO_ADDR in every
+   process and keeps it up to date, so that a process can read
+   the time and its own counters without a system call.  The
+   kernel makes SEQ odd while it updates the page and even again
+   afterward; kinfo_read() uses that to take a consistent
+   snapshot.
+
+   The page at KINFO_ADDR is reserved: the kernel refuses to load
+   an executable with a segment that covers it. */
+
+/* Contents of the info page. */
+struct kinfo
+  {
+    uint32_t seq;               /* Update sequence number. */
+    uint32_t unused;            /* Padding. */
+    int64_t ticks;              /* Timer ticks since boot. */
+    uint64_t tsc_hz;            /* TSC cycles per second, 0 if unknown. */
+    int64_t run_ticks;          /* Timer ticks this process has run. */
+    int64_t page_faults;        /* Page faults this process has taken. */
+  };
+
+/* User address of the info page, below the executable. */
+#define KINFO_ADDR ((const struct kinfo *) 0x08000000)
+
+void kinfo_read (struct kinfo *);
+int64_t kinfo_ticks (void);
+
+#endif /* lib/user/kinfo.h */
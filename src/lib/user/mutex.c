@@ -0,0 +1,75 @@
+#include "mutex.h"
+#include <syscall.h>
+
+/* Atomically replaces *P by NEW if it equals OLD.  Returns the
+   previous value of *P. */
+static inline int
+cmpxchg (int *p, int old, int new) 
+{
+  int prev;
+  asm volatile ("lock cmpxchgl %2, %1"
+                : "=a" (prev), "+m" (*p)
+                : "r" (new), "0" (old)
+                : "memory");
+  return prev;
+}
+
+/* Atomically stores NEW in *P and returns the previous value. */
+static inline int
+xchg (int *p, int new) 
+{
+  asm volatile ("xchgl %0, %1"
+                : "+r" (new), "+m" (*p)
+                :
+                : "memory");
+  return new;
+}
+
+/* Initializes mutex M as unlocked. */
+void
+mutex_init (struct mutex *m) 
+{
+  m->state = MUTEX_UNLOCKED;
+}
+
+/* Acquires mutex M, sleeping until it is available if
+   necessary.  A thread that has had to wait marks M contended,
+   so the holder knows to wake someone when it unlocks.
+
+   futex_wait() returns -1 without sleeping if M's state changed
+   before the kernel saw it, and also if no other thread could
+   ever wake the caller, such as in a process with a single
+   thread.  Either way the loop just tries again, so in the
+   second case the caller spins instead of blocking for good. */
+void
+mutex_lock (struct mutex *m) 
+{
+  int c = cmpxchg (&m->state, MUTEX_UNLOCKED, MUTEX_LOCKED);
+
+  if (c == MUTEX_UNLOCKED)
+    return;
+  if (c != MUTEX_CONTENDED)
+    c = xchg (&m->state, MUTEX_CONTENDED);
+  while (c != MUTEX_UNLOCKED) 
+    {
+      futex_wait (&m->state, MUTEX_CONTENDED);
+      c = xchg (&m->state, MUTEX_CONTENDED);
+    }
+}
+
+/* Tries to acquire mutex M without sleeping.  Returns true if
+   successful, false if M is held. */
+bool
+mutex_trylock (struct mutex *m) 
+{
+  return cmpxchg (&m->state, MUTEX_UNLOCKED, MUTEX_LOCKED) == MUTEX_UNLOCKED;
+}
+
+/* Releases mutex M, which must be held by the caller, waking one
+   waiter if there might be any. */
+void
+mutex_unlock (struct mutex *m) 
+{
+  if (xchg (&m->state, MUTEX_UNLOCKED) == MUTEX_CONTENDED)
+    futex_wake (&m->state, 1);
+}
@@ -0,0 +1,25 @@
+#ifndef __LIB_USER_MUTEX_H
+#define __LIB_USER_MUTEX_H
+
+#include <stdbool.h>
+
+/* User-space mutex built on futex_wait() and futex_wake().
+   Locking and unlocking an uncontended mutex makes no system
+   call; a thread that finds the mutex held sleeps in the kernel
+   instead of spinning, whenever some other thread could wake
+   it. */
+struct mutex
+  {
+    int state;                  /* MUTEX_* below. */
+  };
+
+#define MUTEX_UNLOCKED 0        /* Not held. */
+#define MUTEX_LOCKED 1          /* Held, no waiters. */
+#define MUTEX_CONTENDED 2       /* Held, maybe with waiters. */
+
+void mutex_init (struct mutex *);
+void mutex_lock (struct mutex *);
+bool mutex_trylock (struct mutex *);
+void mutex_unlock (struct mutex *);
+
+#endif /* lib/user/mutex.h */
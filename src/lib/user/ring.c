@@ -0,0 +1,70 @@
+#include "ring.h"
+#include <string.h>
+#include <syscall.h>
+
+/* Initializes R, which must be RING_SIZE-aligned, as an empty
+   ring and registers it with the kernel as this process's ring,
+   replacing any earlier one.  Returns true if successful. */
+bool
+ring_init (struct ring *r) 
+{
+  memset (r, 0, sizeof *r);
+  return ring_setup (r);
+}
+
+/* Returns the next free SQE in R, to be filled in with
+   ring_prep(), or a null pointer if the submission queue is
+   full. */
+struct ring_sqe *
+ring_get_sqe (struct ring *r) 
+{
+  struct ring_sqe *sqe;
+
+  if (r->sq_tail - r->sq_head >= RING_ENTRIES)
+    return NULL;
+  sqe = &r->sqes[r->sq_tail % RING_ENTRIES];
+  r->sq_tail++;
+  return sqe;
+}
+
+/* Fills in SQE to perform OP with the given arguments.
+   USER_DATA is passed back in the operation's CQE. */
+void
+ring_prep (struct ring_sqe *sqe, enum ring_op op, int fd, const void *buf,
+           unsigned len, unsigned offset, uint32_t user_data) 
+{
+  sqe->op = op;
+  sqe->fd = fd;
+  sqe->buf = (uint32_t) buf;
+  sqe->len = len;
+  sqe->offset = offset;
+  sqe->user_data = user_data;
+}
+
+/* Submits every SQE obtained from ring_get_sqe() since the last
+   call, with a single system call.  Returns the number of SQEs
+   carried out, which is fewer than submitted only if the
+   completion queue filled up. */
+int
+ring_submit (struct ring *r) 
+{
+  return ring_enter (r->sq_tail - r->sq_head);
+}
+
+/* Returns the oldest unconsumed CQE in R, or a null pointer if
+   there is none.  The CQE stays in place until ring_cqe_seen()
+   is called. */
+struct ring_cqe *
+ring_peek_cqe (struct ring *r) 
+{
+  if (r->cq_head == r->cq_tail)
+    return NULL;
+  return &r->cqes[r->cq_head % RING_ENTRIES];
+}
+
+/* Consumes the CQE returned by ring_peek_cqe(). */
+void
+ring_cqe_seen (struct ring *r) 
+{
+  r->cq_head++;
+}
@@ -0,0 +1,76 @@
+#ifndef __LIB_USER_RING_H
+#define __LIB_USER_RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Submission/completion ring for batching system calls.
+
+   A process registers one page of its own memory, laid out as
+   struct ring, with ring_setup().  It fills submission queue
+   entries (SQEs) and advances sq_tail, then makes a single
+   ring_enter() call, which carries out every pending SQE in
+   order and posts one completion queue entry (CQE) for each.
+   The process consumes CQEs by advancing cq_head.
+
+   The kernel only reads and writes the ring during ring_enter(),
+   in the context of the process that owns it, so no locking or
+   memory barriers are needed.  Head and tail indexes run freely
+   and are reduced modulo RING_ENTRIES when used. */
+
+#define RING_SIZE 4096          /* Size of struct ring, one page. */
+#define RING_ENTRIES 64         /* SQEs, and CQEs, in a ring. */
+
+/* SQE operations.  Each one behaves like the system call of the
+   same name, except that a bad pointer makes it fail with -1
+   instead of killing the process. */
+enum ring_op
+  {
+    RING_OP_NOP,                /* Do nothing, result 0. */
+    RING_OP_READ,               /* read (fd, buf, len). */
+    RING_OP_WRITE,              /* write (fd, buf, len). */
+    RING_OP_PREAD,              /* pread (fd, buf, len, offset). */
+    RING_OP_PWRITE,             /* pwrite (fd, buf, len, offset). */
+    RING_OP_OPEN,               /* open (buf). */
+    RING_OP_CLOSE               /* close (fd), result 0 or -1. */
+  };
+
+/* Submission queue entry. */
+struct ring_sqe
+  {
+    uint32_t op;                /* RING_OP_*. */
+    int32_t fd;                 /* File descriptor. */
+    uint32_t buf;               /* User buffer or file name. */
+    uint32_t len;               /* Length of BUF in bytes. */
+    uint32_t offset;            /* File offset for PREAD, PWRITE. */
+    uint32_t user_data;         /* Copied to the CQE unchanged. */
+  };
+
+/* Completion queue entry. */
+struct ring_cqe
+  {
+    uint32_t user_data;         /* From the SQE. */
+    int32_t res;                /* What the system call returned. */
+  };
+
+/* Shared ring page. */
+struct ring
+  {
+    uint32_t sq_head;           /* Next SQE for the kernel. */
+    uint32_t sq_tail;           /* Next SQE for the process to fill. */
+    uint32_t cq_head;           /* Next CQE for the process. */
+    uint32_t cq_tail;           /* Next CQE for the kernel to fill. */
+    struct ring_sqe sqes[RING_ENTRIES];
+    struct ring_cqe cqes[RING_ENTRIES];
+  };
+
+bool ring_init (struct ring *);
+struct ring_sqe *ring_get_sqe (struct ring *);
+void ring_prep (struct ring_sqe *, enum ring_op, int fd, const void *buf,
+                unsigned len, unsigned offset, uint32_t user_data);
+int ring_submit (struct ring *);
+struct ring_cqe *ring_peek_cqe (struct ring *);
+void ring_cqe_seen (struct ring *);
+
+#endif /* lib/user/ring.h */
@@ -1,16 +1,26 @@
 #include <syscall.h>
 #include "../syscall-nr.h"
 
+/* System call entry routines, in lib/user/syscall-entry.S. */
+void syscall_int (void);
+void syscall_sysenter (void);
+
+/* Entry routine used for system calls: syscall_sysenter if the
+   CPU supports it and it has not been turned off by
+   syscall_use_sysenter(), otherwise syscall_int. */
+static void (*syscall_entry) (void) = syscall_int;
+
 /* Invokes syscall NUMBER, passing no arguments, and returns the
    return value as an `int'. */
 #define syscall0(NUMBER)                                        \
         ({                                                      \
           int retval;                                           \
           asm volatile                                          \
-            ("pushl %[number]; int $0x30; addl $4, %%esp"       \
+            ("pushl %[number]; call *%[entry]; addl $4, %%esp"  \
                : "=a" (retval)                                  \
-               : [number] "i" (NUMBER)                          \
-               : "memory");                                     \
+               : [number] "i" (NUMBER),                         \
+                 [entry] "m" (syscall_entry)                    \
+               : "ecx", "edx", "memory");                       \
           retval;                                               \
         })
 
@@ -20,11 +30,13 @@
         ({                                                               \
           int retval;                                                    \
           asm volatile                                                   \
-            ("pushl %[arg0]; pushl %[number]; int $0x30; addl $8, %%esp" \
+            ("pushl %[arg0]; pushl %[number]; call *%[entry]; "          \
+             "addl $8, %%esp"                                            \
                : "=a" (retval)                                           \
                : [number] "i" (NUMBER),                                  \
+                 [entry] "m" (syscall_entry),                            \
                  [arg0] "g" (ARG0)                                       \
-               : "memory");                                              \
+               : "ecx", "edx", "memory");                                \
           retval;                                                        \
         })
 
@@ -35,12 +47,13 @@
           int retval;                                           \
           asm volatile                                          \
             ("pushl %[arg1]; pushl %[arg0]; "                   \
-             "pushl %[number]; int $0x30; addl $12, %%esp"      \
+             "pushl %[number]; call *%[entry]; addl $12, %%esp" \
                : "=a" (retval)                                  \
                : [number] "i" (NUMBER),                         \
+                 [entry] "m" (syscall_entry),                   \
                  [arg0] "g" (ARG0),                             \
                  [arg1] "g" (ARG1)                              \
-               : "memory");                                     \
+               : "ecx", "edx", "memory");                       \
           retval;                                               \
         })
 
@@ -51,13 +64,14 @@
           int retval;                                           \
           asm volatile                                          \
             ("pushl %[arg2]; pushl %[arg1]; pushl %[arg0]; "    \
-             "pushl %[number]; int $0x30; addl $16, %%esp"      \
+             "pushl %[number]; call *%[entry]; addl $16, %%esp" \
                : "=a" (retval)                                  \
                : [number] "i" (NUMBER),                         \
+                 [entry] "m" (syscall_entry),                   \
                  [arg0] "g" (ARG0),                             \
                  [arg1] "g" (ARG1),                             \
                  [arg2] "g" (ARG2)                              \
-               : "memory");                                     \
+               : "ecx", "edx", "memory");                       \
           retval;                                               \
         })
 
@@ -65,20 +79,52 @@
    ARG3, and returns the return value as an `int'. */
 #define syscall4(NUMBER, ARG0, ARG1, ARG2, ARG3)                               \
         ({                                                                     \
-          int retval;										    			   \
+          int retval;                                                          \
           asm volatile                                                         \
             ("pushl %[arg3]; pushl %[arg2]; pushl %[arg1]; pushl %[arg0]; "    \
-             "pushl %[number]; int $0x30; addl $16, %%esp"                     \
+             "pushl %[number]; call *%[entry]; addl $20, %%esp"                \
                : "=a" (retval)                                                 \
                : [number] "i" (NUMBER),                                        \
+                 [entry] "m" (syscall_entry),                                  \
                  [arg0] "g" (ARG0),                                            \
                  [arg1] "g" (ARG1),                                            \
                  [arg2] "g" (ARG2),                                            \
                  [arg3] "g" (ARG3)                                             \
-               : "memory");                                                    \
+               : "ecx", "edx", "memory");                                      \
           retval;                                                              \
         })
 
+/* Returns true if the CPU supports SYSENTER and SYSEXIT, in which
+   case the kernel has set them up.  Early Pentium Pros claim to
+   support them but do not. */
+static bool
+sysenter_supported (void) 
+{
+  unsigned eax, ebx, ecx, edx;
+  unsigned family, model, stepping;
+
+  asm volatile ("cpuid"
+                : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+                : "a" (1));
+  family = (eax >> 8) & 0xf;
+  model = (eax >> 4) & 0xf;
+  stepping = eax & 0xf;
+  if (family == 6 && model < 3 && stepping < 3)
+    return false;
+  return (edx & (1 << 11)) != 0;
+}
+
+/* Makes system calls use SYSENTER if ENABLE is true and the CPU
+   supports it, and `int $0x30' otherwise.  Returns true if
+   SYSENTER is now in use.  Called with ENABLE true at startup. */
+bool
+syscall_use_sysenter (bool enable) 
+{
+  syscall_entry = (enable && sysenter_supported ()
+                   ? syscall_sysenter : syscall_int);
+  return syscall_entry == syscall_sysenter;
+}
+
 void
 halt (void) 
 {
@@ -105,6 +151,19 @@ wait (pid_t pid)
   return syscall1 (SYS_WAIT, pid);
 }
 
+pid_t
+waitpid (pid_t pid, int *status, int options)
+{
+  return syscall3 (SYS_WAITPID, pid, status, options);
+}
+
+/* Waits for whichever child exits first. */
+pid_t
+wait_any (int *status)
+{
+  return waitpid (-1, status, 0);
+}
+
 bool
 create (const char *file, unsigned initial_size)
 {
@@ -212,3 +271,69 @@ sumFour (int a, int b, int c, int d)
 {
   return syscall4 (SYS_SUMFOUR, a, b, c, d);
 }
+
+int
+set_tickets (int tickets)
+{
+  return syscall1 (SYS_TICKETS, tickets);
+}
+
+int
+futex_wait (int *addr, int expected)
+{
+  return syscall2 (SYS_FUTEX_WAIT, addr, expected);
+}
+
+int
+futex_wake (int *addr, int n)
+{
+  return syscall2 (SYS_FUTEX_WAKE, addr, n);
+}
+
+int
+dup (int fd)
+{
+  return syscall1 (SYS_DUP, fd);
+}
+
+int
+dup2 (int oldfd, int newfd)
+{
+  return syscall2 (SYS_DUP2, oldfd, newfd);
+}
+
+int
+pread (int fd, void *buffer, unsigned size, unsigned offset)
+{
+  return syscall4 (SYS_PREAD, fd, buffer, size, offset);
+}
+
+int
+pwrite (int fd, const void *buffer, unsigned size, unsigned offset)
+{
+  return syscall4 (SYS_PWRITE, fd, buffer, size, offset);
+}
+
+int
+readv (int fd, const struct iovec *iov, int iovcnt)
+{
+  return syscall3 (SYS_READV, fd, iov, iovcnt);
+}
+
+int
+writev (int fd, const struct iovec *iov, int iovcnt)
+{
+  return syscall3 (SYS_WRITEV, fd, iov, iovcnt);
+}
+
+bool
+ring_setup (struct ring *ring)
+{
+  return syscall1 (SYS_RING_SETUP, ring);
+}
+
+int
+ring_enter (unsigned to_submit)
+{
+  return syscall1 (SYS_RING_ENTER, to_submit);
+}
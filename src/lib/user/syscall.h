@@ -2,12 +2,18 @@
 #define __LIB_USER_SYSCALL_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <debug.h>
 
+struct ring;
+
 /* Process identifier. */
 typedef int pid_t;
 #define PID_ERROR ((pid_t) -1)
 
+/* Options for waitpid(). */
+#define WNOHANG 1               /* Return 0 instead of waiting. */
+
 /* Map region identifier. */
 typedef int mapid_t;
 #define MAP_FAILED ((mapid_t) -1)
@@ -15,6 +21,16 @@ typedef int mapid_t;
 /* Maximum characters in a filename written by readdir(). */
 #define READDIR_MAX_LEN 14
 
+/* One buffer for readv() and writev(). */
+struct iovec
+  {
+    void *iov_base;             /* Start of buffer. */
+    size_t iov_len;             /* Length of buffer in bytes. */
+  };
+
+/* Maximum number of buffers passed to readv() or writev(). */
+#define IOV_MAX 64
+
 /* Typical return values from main() and arguments to exit(). */
 #define EXIT_SUCCESS 0          /* Successful execution. */
 #define EXIT_FAILURE 1          /* Unsuccessful execution. */
@@ -24,6 +40,8 @@ void halt (void) NO_RETURN;
 void exit (int status) NO_RETURN;
 pid_t exec (const char *file);
 int wait (pid_t);
+pid_t waitpid (pid_t, int *status, int options);
+pid_t wait_any (int *status);
 bool create (const char *file, unsigned initial_size);
 bool remove (const char *file);
 int open (const char *file);
@@ -35,6 +53,18 @@ unsigned tell (int fd);
 void close (int fd);
 int fib (int n);
 int sumFour (int a, int b, int c, int d);
+int set_tickets (int tickets);
+int futex_wait (int *addr, int expected);
+int futex_wake (int *addr, int n);
+int dup (int fd);
+int dup2 (int oldfd, int newfd);
+int pread (int fd, void *buffer, unsigned length, unsigned offset);
+int pwrite (int fd, const void *buffer, unsigned length, unsigned offset);
+int readv (int fd, const struct iovec *iov, int iovcnt);
+int writev (int fd, const struct iovec *iov, int iovcnt);
+bool ring_setup (struct ring *ring);
+int ring_enter (unsigned to_submit);
+bool syscall_use_sysenter (bool enable);
 
 /* Project 3 and optionally project 4. */
 mapid_t mmap (int fd, void *addr);
@@ -0,0 +1,67 @@
+/* Puts threads of 32 different priorities to sleep until the
+   same tick, and checks that the timer interrupt wakes all of
+   them in that tick, as one batch, so that they then run in
+   order of priority, highest first. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define THREAD_CNT 32
+
+static int64_t wake_time;
+static struct semaphore done;
+
+/* Priority and wake-up tick of each sleeper, in the order they
+   ran after waking.  The sleepers all have different priorities,
+   so none preempts another and they need no locking. */
+static int woke_pri[THREAD_CNT];
+static int64_t woke_at[THREAD_CNT];
+static int woke_cnt;
+
+static thread_func sleeper;
+
+void
+test_alarm_burst (void) 
+{
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  sema_init (&done, 0);
+  wake_time = timer_ticks () + 5 * TIMER_FREQ / 10;
+
+  msg ("Creating %d threads to sleep until the same tick.", THREAD_CNT);
+  for (i = 0; i < THREAD_CNT; i++) 
+    {
+      int priority = PRI_DEFAULT + 1 + i * 13 % THREAD_CNT;
+      char name[16];
+      snprintf (name, sizeof name, "priority %d", priority);
+      thread_create (name, priority, sleeper, NULL);
+    }
+
+  for (i = 0; i < THREAD_CNT; i++)
+    sema_down (&done);
+
+  for (i = 0; i < THREAD_CNT; i++)
+    {
+      if (woke_at[i] != wake_time)
+        fail ("thread priority %d woke up at tick %lld, not tick %lld",
+              woke_pri[i], woke_at[i], wake_time);
+      msg ("Thread priority %d woke up.", woke_pri[i]);
+    }
+}
+
+static void
+sleeper (void *aux UNUSED) 
+{
+  timer_sleep (wake_time - timer_ticks ());
+  woke_at[woke_cnt] = timer_ticks ();
+  woke_pri[woke_cnt] = thread_get_priority ();
+  woke_cnt++;
+  sema_up (&done);
+}
@@ -0,0 +1,42 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(alarm-burst) begin
+(alarm-burst) Creating 32 threads to sleep until the same tick.
+(alarm-burst) Thread priority 63 woke up.
+(alarm-burst) Thread priority 62 woke up.
+(alarm-burst) Thread priority 61 woke up.
+(alarm-burst) Thread priority 60 woke up.
+(alarm-burst) Thread priority 59 woke up.
+(alarm-burst) Thread priority 58 woke up.
+(alarm-burst) Thread priority 57 woke up.
+(alarm-burst) Thread priority 56 woke up.
+(alarm-burst) Thread priority 55 woke up.
+(alarm-burst) Thread priority 54 woke up.
+(alarm-burst) Thread priority 53 woke up.
+(alarm-burst) Thread priority 52 woke up.
+(alarm-burst) Thread priority 51 woke up.
+(alarm-burst) Thread priority 50 woke up.
+(alarm-burst) Thread priority 49 woke up.
+(alarm-burst) Thread priority 48 woke up.
+(alarm-burst) Thread priority 47 woke up.
+(alarm-burst) Thread priority 46 woke up.
+(alarm-burst) Thread priority 45 woke up.
+(alarm-burst) Thread priority 44 woke up.
+(alarm-burst) Thread priority 43 woke up.
+(alarm-burst) Thread priority 42 woke up.
+(alarm-burst) Thread priority 41 woke up.
+(alarm-burst) Thread priority 40 woke up.
+(alarm-burst) Thread priority 39 woke up.
+(alarm-burst) Thread priority 38 woke up.
+(alarm-burst) Thread priority 37 woke up.
+(alarm-burst) Thread priority 36 woke up.
+(alarm-burst) Thread priority 35 woke up.
+(alarm-burst) Thread priority 34 woke up.
+(alarm-burst) Thread priority 33 woke up.
+(alarm-burst) Thread priority 32 woke up.
+(alarm-burst) end
+EOF
+pass;
@@ -0,0 +1,39 @@
+/* Measures the cost of creating a thread and running it to
+   completion.  Each child has a higher priority than the main
+   thread, so thread_create() does not return until the child has
+   run and exited.  A sample covers the creation, two context
+   switches, and the child's exit. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "tests/threads/bench.h"
+#include "threads/init.h"
+#include "threads/thread.h"
+
+static thread_func empty_thread;
+static uint64_t samples[BENCH_SAMPLES];
+
+void
+test_bench_create (void) 
+{
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  for (i = -BENCH_WARMUP; i < BENCH_SAMPLES; i++) 
+    {
+      uint64_t start = rdtsc ();
+      thread_create ("child", thread_get_priority () + 1,
+                     empty_thread, NULL);
+      if (i >= 0)
+        samples[i] = rdtsc () - start;
+    }
+
+  bench_report ("create", samples, BENCH_SAMPLES);
+}
+
+static void
+empty_thread (void *aux UNUSED) 
+{
+}
@@ -0,0 +1,44 @@
+/* Measures the cost of a context switch.  The main thread and a
+   helper thread of the same priority take turns calling
+   thread_yield(), so each yield by the main thread is a round
+   trip of two switches; half of it is reported. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "tests/threads/bench.h"
+#include "threads/init.h"
+#include "threads/thread.h"
+
+static thread_func yield_thread;
+static uint64_t samples[BENCH_SAMPLES];
+static volatile bool done;
+
+void
+test_bench_ctxswitch (void) 
+{
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  done = false;
+  thread_create ("yielder", thread_get_priority (), yield_thread, NULL);
+  for (i = -BENCH_WARMUP; i < BENCH_SAMPLES; i++) 
+    {
+      uint64_t start = rdtsc ();
+      thread_yield ();
+      if (i >= 0)
+        samples[i] = (rdtsc () - start) / 2;
+    }
+  done = true;
+  thread_yield ();
+
+  bench_report ("ctxswitch", samples, BENCH_SAMPLES);
+}
+
+static void
+yield_thread (void *aux UNUSED) 
+{
+  while (!done)
+    thread_yield ();
+}
@@ -0,0 +1,60 @@
+/* Measures lock handoff latency: the time from lock_release() by
+   the holder until lock_acquire() returns in a higher-priority
+   thread that was blocked on the lock.  This covers donation,
+   the release, the wakeup, and one context switch. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "tests/threads/bench.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func acquire_thread;
+static uint64_t samples[BENCH_SAMPLES];
+static struct lock lock;
+static struct semaphore ready;
+static volatile uint64_t release_time;
+
+void
+test_bench_lock (void) 
+{
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  lock_init (&lock);
+  sema_init (&ready, 0);
+  thread_create ("acquirer", thread_get_priority () + 1,
+                 acquire_thread, NULL);
+  for (i = -BENCH_WARMUP; i < BENCH_SAMPLES; i++) 
+    {
+      lock_acquire (&lock);
+
+      /* The acquirer preempts us and blocks on the lock. */
+      sema_up (&ready);
+
+      /* The acquirer preempts us again, records the sample, and
+         blocks on READY. */
+      release_time = rdtsc ();
+      lock_release (&lock);
+    }
+
+  bench_report ("lock handoff", samples, BENCH_SAMPLES);
+}
+
+static void
+acquire_thread (void *aux UNUSED) 
+{
+  int i;
+
+  for (i = -BENCH_WARMUP; i < BENCH_SAMPLES; i++) 
+    {
+      sema_down (&ready);
+      lock_acquire (&lock);
+      if (i >= 0)
+        samples[i] = rdtsc () - release_time;
+      lock_release (&lock);
+    }
+}
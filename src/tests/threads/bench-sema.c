@@ -0,0 +1,51 @@
+/* Measures semaphore ping-pong latency.  The main thread ups a
+   semaphore that a helper thread is waiting on, then downs a
+   second semaphore that the helper ups in reply.  Each sample is
+   one round trip: two sema_up()/sema_down() pairs and two
+   context switches. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "tests/threads/bench.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func pong_thread;
+static uint64_t samples[BENCH_SAMPLES];
+static struct semaphore ping, pong;
+
+void
+test_bench_sema (void) 
+{
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  sema_init (&ping, 0);
+  sema_init (&pong, 0);
+  thread_create ("pong", thread_get_priority (), pong_thread, NULL);
+  for (i = -BENCH_WARMUP; i < BENCH_SAMPLES; i++) 
+    {
+      uint64_t start = rdtsc ();
+      sema_up (&ping);
+      sema_down (&pong);
+      if (i >= 0)
+        samples[i] = rdtsc () - start;
+    }
+
+  bench_report ("sema ping-pong", samples, BENCH_SAMPLES);
+}
+
+static void
+pong_thread (void *aux UNUSED) 
+{
+  int i;
+
+  for (i = -BENCH_WARMUP; i < BENCH_SAMPLES; i++) 
+    {
+      sema_down (&ping);
+      sema_up (&pong);
+    }
+}
@@ -0,0 +1,31 @@
+/* Helpers shared by the bench-* tests. */
+
+#include "tests/threads/bench.h"
+#include <debug.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include "tests/threads/tests.h"
+
+/* Orders uint64_t's ascending, for qsort(). */
+static int
+compare_u64 (const void *a_, const void *b_) 
+{
+  const uint64_t *a = a_;
+  const uint64_t *b = b_;
+
+  return *a < *b ? -1 : *a > *b;
+}
+
+/* Sorts the CNT cycle counts in SAMPLES and reports their
+   minimum, median, and 99th percentile as one line:
+   "NAME: CNT samples, min M, median D, p99 P cycles/op". */
+void
+bench_report (const char *name, uint64_t *samples, size_t cnt) 
+{
+  ASSERT (cnt > 0);
+
+  qsort (samples, cnt, sizeof *samples, compare_u64);
+  msg ("%s: %zu samples, min %"PRIu64", median %"PRIu64", "
+       "p99 %"PRIu64" cycles/op",
+       name, cnt, samples[0], samples[cnt / 2], samples[cnt * 99 / 100]);
+}
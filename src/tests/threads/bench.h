@@ -0,0 +1,15 @@
+#ifndef TESTS_THREADS_BENCH_H
+#define TESTS_THREADS_BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "threads/cpu.h"
+
+/* Number of timed operations per benchmark, after BENCH_WARMUP
+   untimed ones. */
+#define BENCH_SAMPLES 1000
+#define BENCH_WARMUP 16
+
+void bench_report (const char *name, uint64_t *samples, size_t cnt);
+
+#endif /* tests/threads/bench.h */
@@ -0,0 +1,25 @@
+# -*- perl -*-
+use strict;
+use warnings;
+
+# Checks that a bench-* test printed a result line in the
+# expected format for each of the given names.  The numbers
+# themselves are not checked.
+sub check_bench {
+    my (@names) = @_;
+    our ($test);
+    my (@output) = read_text_file ("$test.output");
+    common_checks ("run", @output);
+    @output = get_core_output ("run", @output);
+
+    my ($tag) = $test;
+    $tag =~ s%.*/%%;
+    foreach my $name (@names) {
+	grep (/^\($tag\) \Q$name\E: \d+ samples, min \d+, median \d+, p99 \d+ cycles\/op$/,
+	      @output)
+	  or fail "Missing or malformed \"$name\" result line.\n";
+    }
+    pass;
+}
+
+1;
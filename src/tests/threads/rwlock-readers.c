@@ -0,0 +1,62 @@
+/* Checks that readers of a reader-writer lock proceed in
+   parallel.  Each of several threads acquires the lock shared
+   and waits, holding it, for all the others to get in too. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define READER_CNT 5
+
+static thread_func reader_thread;
+static struct rwlock rwlock;
+static struct semaphore done;
+static int inside, max_inside;
+
+void
+test_rwlock_readers (void) 
+{
+  int i;
+
+  rwlock_init (&rwlock);
+  sema_init (&done, 0);
+  inside = max_inside = 0;
+  for (i = 0; i < READER_CNT; i++) 
+    {
+      char name[16];
+      snprintf (name, sizeof name, "reader %d", i);
+      thread_create (name, PRI_DEFAULT, reader_thread, NULL);
+    }
+  for (i = 0; i < READER_CNT; i++)
+    sema_down (&done);
+
+  msg ("%d readers held the lock at once.", max_inside);
+}
+
+static void
+reader_thread (void *aux UNUSED) 
+{
+  int64_t start = timer_ticks ();
+  enum intr_level old_level;
+
+  rwlock_acquire_shared (&rwlock);
+  old_level = intr_disable ();
+  inside++;
+  if (inside > max_inside)
+    max_inside = inside;
+  intr_set_level (old_level);
+
+  /* Give up after a second if the others cannot get in. */
+  while (inside < READER_CNT && timer_elapsed (start) < TIMER_FREQ)
+    timer_sleep (1);
+
+  old_level = intr_disable ();
+  inside--;
+  intr_set_level (old_level);
+  rwlock_release_shared (&rwlock);
+  sema_up (&done);
+}
@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock-readers) begin
+(rwlock-readers) 5 readers held the lock at once.
+(rwlock-readers) end
+EOF
+pass;
@@ -0,0 +1,53 @@
+/* Checks upgrade and downgrade of a reader-writer lock.  The
+   main thread holds the lock shared while a writer and then a
+   reader queue up behind it.  The upgrade must go ahead of the
+   waiting writer, and after the downgrade the writer must still
+   go ahead of the waiting reader. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func writer_thread;
+static thread_func reader_thread;
+static struct rwlock rwlock;
+
+void
+test_rwlock_upgrade (void) 
+{
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  rwlock_init (&rwlock);
+  rwlock_acquire_shared (&rwlock);
+  thread_create ("writer", PRI_DEFAULT + 1, writer_thread, NULL);
+  thread_create ("reader", PRI_DEFAULT + 1, reader_thread, NULL);
+
+  if (!rwlock_upgrade (&rwlock))
+    fail ("Upgrade failed.");
+  msg ("Main upgraded.");
+  rwlock_downgrade (&rwlock);
+  msg ("Main downgraded.");
+  rwlock_release_shared (&rwlock);
+  msg ("Main done.");
+}
+
+static void
+writer_thread (void *aux UNUSED) 
+{
+  msg ("Writer waiting.");
+  rwlock_acquire_exclusive (&rwlock);
+  msg ("Writer acquired the lock.");
+  rwlock_release_exclusive (&rwlock);
+}
+
+static void
+reader_thread (void *aux UNUSED) 
+{
+  msg ("Reader waiting.");
+  rwlock_acquire_shared (&rwlock);
+  msg ("Reader acquired the lock.");
+  rwlock_release_shared (&rwlock);
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock-upgrade) begin
+(rwlock-upgrade) Writer waiting.
+(rwlock-upgrade) Reader waiting.
+(rwlock-upgrade) Main upgraded.
+(rwlock-upgrade) Main downgraded.
+(rwlock-upgrade) Writer acquired the lock.
+(rwlock-upgrade) Reader acquired the lock.
+(rwlock-upgrade) Main done.
+(rwlock-upgrade) end
+EOF
+pass;
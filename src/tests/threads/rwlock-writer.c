@@ -0,0 +1,69 @@
+/* Checks that a writer is not starved by readers.  Several
+   threads take turns holding a reader-writer lock shared, always
+   overlapping, so without writer preference there is never a
+   moment when no reader holds it. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define READER_CNT 3
+#define HOLD_TICKS 3
+
+static thread_func reader_thread;
+static struct rwlock rwlock;
+static struct semaphore done;
+static volatile bool writer_done;
+
+void
+test_rwlock_writer (void) 
+{
+  int64_t start, waited;
+  int i;
+
+  rwlock_init (&rwlock);
+  sema_init (&done, 0);
+  writer_done = false;
+  for (i = 0; i < READER_CNT; i++) 
+    {
+      char name[16];
+      snprintf (name, sizeof name, "reader %d", i);
+      thread_create (name, PRI_DEFAULT, reader_thread, (void *) i);
+    }
+
+  /* Let the readers get going. */
+  timer_sleep (10);
+
+  start = timer_ticks ();
+  rwlock_acquire_exclusive (&rwlock);
+  waited = timer_elapsed (start);
+  writer_done = true;
+  rwlock_release_exclusive (&rwlock);
+  msg ("Writer acquired the lock.");
+  if (waited > 2 * HOLD_TICKS)
+    fail ("Writer waited %lld ticks, should be at most %d.",
+          waited, 2 * HOLD_TICKS);
+
+  for (i = 0; i < READER_CNT; i++)
+    sema_down (&done);
+  msg ("Readers done.");
+}
+
+static void
+reader_thread (void *i_) 
+{
+  int i = (int) i_;
+
+  /* Stagger the readers so their holds overlap. */
+  timer_sleep (i);
+  while (!writer_done) 
+    {
+      rwlock_acquire_shared (&rwlock);
+      timer_sleep (HOLD_TICKS);
+      rwlock_release_shared (&rwlock);
+    }
+  sema_up (&done);
+}
@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock-writer) begin
+(rwlock-writer) Writer acquired the lock.
+(rwlock-writer) Readers done.
+(rwlock-writer) end
+EOF
+pass;
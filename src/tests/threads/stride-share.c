@@ -0,0 +1,72 @@
+/* Checks that the stride scheduler divides the CPU in proportion
+   to tickets.  Three threads with 100, 200, and 300 tickets spin
+   for 30 seconds, so they should receive 500, 1,000, and 1,500
+   ticks, respectively. */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define THREAD_CNT 3
+
+struct thread_info 
+  {
+    int64_t start_time;
+    int tick_count;
+    int tickets;
+  };
+
+static void load_thread (void *aux);
+
+void
+test_stride_share (void) 
+{
+  struct thread_info info[THREAD_CNT];
+  int64_t start_time;
+  int i;
+
+  ASSERT (thread_stride);
+
+  start_time = timer_ticks ();
+  msg ("Starting %d threads...", THREAD_CNT);
+  for (i = 0; i < THREAD_CNT; i++) 
+    {
+      struct thread_info *ti = &info[i];
+      char name[16];
+
+      ti->start_time = start_time;
+      ti->tick_count = 0;
+      ti->tickets = (i + 1) * 100;
+
+      snprintf (name, sizeof name, "load %d", i);
+      thread_create (name, PRI_DEFAULT, load_thread, ti);
+    }
+
+  msg ("Sleeping 40 seconds to let threads run, please wait...");
+  timer_sleep (40 * TIMER_FREQ);
+  
+  for (i = 0; i < THREAD_CNT; i++)
+    msg ("Thread %d received %d ticks.", i, info[i].tick_count);
+}
+
+static void
+load_thread (void *ti_) 
+{
+  struct thread_info *ti = ti_;
+  int64_t sleep_time = 5 * TIMER_FREQ;
+  int64_t spin_time = sleep_time + 30 * TIMER_FREQ;
+  int64_t last_time = 0;
+
+  thread_set_tickets (ti->tickets);
+  timer_sleep (sleep_time - timer_elapsed (ti->start_time));
+  while (timer_elapsed (ti->start_time) < spin_time) 
+    {
+      int64_t cur_time = timer_ticks ();
+      if (cur_time != last_time)
+        ti->tick_count++;
+      last_time = cur_time;
+    }
+}
@@ -17,6 +17,8 @@ static const struct test tests[] =
     {"alarm-priority", test_alarm_priority},
     {"alarm-zero", test_alarm_zero},
     {"alarm-negative", test_alarm_negative},
+    {"alarm-burst", test_alarm_burst},
+    {"timer-ns", test_timer_ns},
     {"priority-change", test_priority_change},
     {"priority-change-2", test_priority_change_2},
     {"priority-donate-one", test_priority_donate_one},
@@ -41,6 +43,14 @@ static const struct test tests[] =
     {"mlfqs-nice-2", test_mlfqs_nice_2},
     {"mlfqs-nice-10", test_mlfqs_nice_10},
     {"mlfqs-block", test_mlfqs_block},
+    {"stride-share", test_stride_share},
+    {"bench-ctxswitch", test_bench_ctxswitch},
+    {"bench-sema", test_bench_sema},
+    {"bench-lock", test_bench_lock},
+    {"bench-create", test_bench_create},
+    {"rwlock-readers", test_rwlock_readers},
+    {"rwlock-writer", test_rwlock_writer},
+    {"rwlock-upgrade", test_rwlock_upgrade},
   };
 
 static const char *test_name;
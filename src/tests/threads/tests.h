@@ -11,6 +11,8 @@ extern test_func test_alarm_simultaneous;
 extern test_func test_alarm_priority;
 extern test_func test_alarm_zero;
 extern test_func test_alarm_negative;
+extern test_func test_alarm_burst;
+extern test_func test_timer_ns;
 extern test_func test_priority_change;
 extern test_func test_priority_change_2;
 extern test_func test_priority_donate_one;
@@ -35,6 +37,14 @@ extern test_func test_mlfqs_fair_20;
 extern test_func test_mlfqs_nice_2;
 extern test_func test_mlfqs_nice_10;
 extern test_func test_mlfqs_block;
+extern test_func test_stride_share;
+extern test_func test_bench_ctxswitch;
+extern test_func test_bench_sema;
+extern test_func test_bench_lock;
+extern test_func test_bench_create;
+extern test_func test_rwlock_readers;
+extern test_func test_rwlock_writer;
+extern test_func test_rwlock_upgrade;
 
 void msg (const char *, ...);
 void fail (const char *, ...);
@@ -0,0 +1,56 @@
+/* Checks that timer_now_ns() never goes backward, that it agrees
+   roughly with the timer tick count, and that timer_udelay()
+   waits about as long as asked. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+/* Returns true if MEASURED is within a factor of 2 of EXPECTED.
+   The TSC and the PIT are only loosely in step under an
+   emulator, so nothing tighter can be expected. */
+static bool
+roughly (uint64_t measured, uint64_t expected) 
+{
+  return measured >= expected / 2 && measured <= expected * 2;
+}
+
+void
+test_timer_ns (void) 
+{
+  uint64_t start_ns, prev_ns, now_ns;
+  int64_t start;
+  int i;
+
+  msg ("Reading timer_now_ns() 1000 times.");
+  prev_ns = timer_now_ns ();
+  for (i = 0; i < 1000; i++) 
+    {
+      now_ns = timer_now_ns ();
+      if (now_ns < prev_ns)
+        fail ("timer_now_ns() went backward");
+      prev_ns = now_ns;
+    }
+
+  msg ("Sleeping 50 ticks.");
+  start = timer_ticks ();
+  while (timer_ticks () == start)
+    thread_yield ();
+  start = timer_ticks ();
+  start_ns = timer_now_ns ();
+  timer_sleep (50);
+  now_ns = timer_now_ns ();
+  if (!roughly (now_ns - start_ns,
+                (uint64_t) timer_elapsed (start) * 1000000000 / TIMER_FREQ))
+    fail ("%lld ticks took %llu ns", timer_elapsed (start),
+          now_ns - start_ns);
+
+  msg ("Delaying 500 us.");
+  start_ns = timer_now_ns ();
+  timer_udelay (500);
+  now_ns = timer_now_ns ();
+  if (!roughly (now_ns - start_ns, 500 * 1000))
+    fail ("500 us delay took %llu ns", now_ns - start_ns);
+}
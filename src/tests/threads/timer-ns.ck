@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(timer-ns) begin
+(timer-ns) Reading timer_now_ns() 1000 times.
+(timer-ns) Sleeping 50 ticks.
+(timer-ns) Delaying 500 us.
+(timer-ns) end
+EOF
+pass;
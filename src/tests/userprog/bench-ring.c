@@ -0,0 +1,120 @@
+/* Compares the per-operation cost of 512-byte reads and writes
+   made one system call at a time with the same operations
+   batched through a submission/completion ring, and reports each
+   in the same format as bench-syscall. */
+
+#include <ring.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define SAMPLES 64              /* Batches timed per benchmark. */
+#define WARMUP 4                /* Untimed batches first. */
+#define BATCH 32                /* Operations per batch. */
+#define BLOCK 512               /* Bytes per operation. */
+
+static uint64_t samples[SAMPLES];
+static char buf[BATCH][BLOCK];
+static struct ring ring __attribute__ ((aligned (RING_SIZE)));
+
+/* Returns the processor's time-stamp counter. */
+static inline uint64_t
+rdtsc (void) 
+{
+  uint64_t tsc;
+  asm volatile ("rdtsc" : "=A" (tsc));
+  return tsc;
+}
+
+/* Orders uint64_t's ascending, for qsort(). */
+static int
+compare_u64 (const void *a_, const void *b_) 
+{
+  const uint64_t *a = a_;
+  const uint64_t *b = b_;
+
+  return *a < *b ? -1 : *a > *b;
+}
+
+/* Makes BATCH reads or writes of BLOCK bytes each on FD, one
+   system call per operation. */
+static void
+batch_plain (int fd, enum ring_op op) 
+{
+  int i;
+
+  for (i = 0; i < BATCH; i++) 
+    {
+      int cnt = (op == RING_OP_READ
+                 ? read (fd, buf[i], BLOCK)
+                 : write (fd, buf[i], BLOCK));
+      if (cnt != BLOCK)
+        fail ("short transfer");
+    }
+}
+
+/* Makes BATCH reads or writes of BLOCK bytes each on FD through
+   the ring, with one system call for the whole batch. */
+static void
+batch_ring (int fd, enum ring_op op) 
+{
+  struct ring_cqe *cqe;
+  int i;
+
+  for (i = 0; i < BATCH; i++)
+    ring_prep (ring_get_sqe (&ring), op, fd, buf[i], BLOCK, 0, i);
+  if (ring_submit (&ring) != BATCH)
+    fail ("ring_submit failed");
+  while ((cqe = ring_peek_cqe (&ring)) != NULL) 
+    {
+      if (cqe->res != BLOCK)
+        fail ("short transfer on ring entry %u", cqe->user_data);
+      ring_cqe_seen (&ring);
+    }
+}
+
+/* Times SAMPLES calls to BATCH_FUNC (FD, OP), each starting from
+   the beginning of the file, and reports the cost per operation
+   as NAME. */
+static void
+bench (const char *name, void (*batch_func) (int, enum ring_op),
+       int fd, enum ring_op op) 
+{
+  int i;
+
+  for (i = -WARMUP; i < SAMPLES; i++) 
+    {
+      uint64_t start;
+
+      seek (fd, 0);
+      start = rdtsc ();
+      batch_func (fd, op);
+      if (i >= 0)
+        samples[i] = (rdtsc () - start) / BATCH;
+    }
+
+  qsort (samples, SAMPLES, sizeof *samples, compare_u64);
+  msg ("%s: %d samples, min %llu, median %llu, p99 %llu cycles/op",
+       name, SAMPLES, samples[0], samples[SAMPLES / 2],
+       samples[SAMPLES * 99 / 100]);
+}
+
+void
+test_main (void) 
+{
+  int fd;
+
+  if (!create ("bench.dat", BATCH * BLOCK))
+    fail ("create \"bench.dat\" failed");
+  if ((fd = open ("bench.dat")) < 2)
+    fail ("open \"bench.dat\" failed");
+  if (!ring_init (&ring))
+    fail ("ring_init failed");
+
+  bench ("write 512 bytes", batch_plain, fd, RING_OP_WRITE);
+  bench ("ring write 512 bytes", batch_ring, fd, RING_OP_WRITE);
+  bench ("read 512 bytes", batch_plain, fd, RING_OP_READ);
+  bench ("ring read 512 bytes", batch_ring, fd, RING_OP_READ);
+}
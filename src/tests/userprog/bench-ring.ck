@@ -0,0 +1,7 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::threads::bench;
+check_bench ("write 512 bytes", "ring write 512 bytes",
+	     "read 512 bytes", "ring read 512 bytes");
@@ -0,0 +1,66 @@
+/* Measures the round-trip cost of a system call that does almost
+   nothing, sumFour(), first through `int $0x30' and then through
+   SYSENTER/SYSEXIT, and reports each in the same format as the
+   bench-* tests in tests/threads. */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define SAMPLES 1000
+#define WARMUP 16
+
+static uint64_t samples[SAMPLES];
+
+/* Returns the processor's time-stamp counter. */
+static inline uint64_t
+rdtsc (void) 
+{
+  uint64_t tsc;
+  asm volatile ("rdtsc" : "=A" (tsc));
+  return tsc;
+}
+
+/* Orders uint64_t's ascending, for qsort(). */
+static int
+compare_u64 (const void *a_, const void *b_) 
+{
+  const uint64_t *a = a_;
+  const uint64_t *b = b_;
+
+  return *a < *b ? -1 : *a > *b;
+}
+
+/* Times SAMPLES calls to sumFour() and reports them as NAME. */
+static void
+bench (const char *name) 
+{
+  int i;
+
+  for (i = -WARMUP; i < SAMPLES; i++) 
+    {
+      uint64_t start = rdtsc ();
+      if (sumFour (1, 2, 3, 4) != 10)
+        fail ("sumFour returned wrong sum");
+      if (i >= 0)
+        samples[i] = rdtsc () - start;
+    }
+
+  qsort (samples, SAMPLES, sizeof *samples, compare_u64);
+  msg ("%s: %d samples, min %llu, median %llu, p99 %llu cycles/op",
+       name, SAMPLES, samples[0], samples[SAMPLES / 2],
+       samples[SAMPLES * 99 / 100]);
+}
+
+void
+test_main (void) 
+{
+  syscall_use_sysenter (false);
+  bench ("int 0x30 null syscall");
+
+  if (!syscall_use_sysenter (true))
+    fail ("CPU does not support sysenter");
+  bench ("sysenter null syscall");
+}
@@ -0,0 +1,31 @@
+/* Duplicates a file descriptor with dup() and dup2(), and checks
+   that the copies share one file position, that closing one
+   leaves the others open, and that dup() hands out the lowest
+   free descriptor. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  int fd, fd2, fd3;
+  char c;
+
+  CHECK ((fd = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK ((fd2 = dup (fd)) > 1 && fd2 != fd, "dup");
+  CHECK (read (fd, &c, 1) == 1, "read one byte");
+  CHECK (tell (fd2) == 1, "position shared by dup");
+
+  fd3 = fd2 + 5;
+  CHECK (dup2 (fd, fd3) == fd3, "dup2 to unused descriptor %d", fd3);
+  seek (fd3, 10);
+  CHECK (tell (fd) == 10, "position shared by dup2");
+
+  close (fd);
+  CHECK (tell (fd2) == 10, "dup survives closing the original");
+  CHECK (dup (fd2) == fd, "dup reuses lowest free descriptor");
+  CHECK (dup (123456) == -1, "dup of bad descriptor");
+  CHECK (dup2 (fd2, 0) == -1, "dup2 onto console descriptor");
+}
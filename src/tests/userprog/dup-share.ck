@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(dup-share) begin
+(dup-share) open "sample.txt"
+(dup-share) dup
+(dup-share) read one byte
+(dup-share) position shared by dup
+(dup-share) dup2 to unused descriptor 8
+(dup-share) position shared by dup2
+(dup-share) dup survives closing the original
+(dup-share) dup reuses lowest free descriptor
+(dup-share) dup of bad descriptor
+(dup-share) dup2 onto console descriptor
+(dup-share) end
+dup-share: exit(0)
+EOF
+pass;
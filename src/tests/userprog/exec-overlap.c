@@ -0,0 +1,82 @@
+/* Writes out and runs an executable with two read-only segments
+   that come from the same page of the file but read different
+   amounts of it.  The shared text cache must give each its own
+   frame, not panic the kernel. */
+
+#include <stdint.h>
+#include <string.h>
+#include <syscall.h>
+#include <syscall-nr.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define CODE_OFS 0x80           /* Offset of the code in the file. */
+#define TEXT_VADDR 0x08048000   /* First segment. */
+#define DATA_VADDR 0x08049000   /* Second segment. */
+
+static uint8_t image[CODE_OFS + 16];
+
+/* Stores VALUE, SIZE bytes long, little-endian at OFS in image. */
+static void
+put (size_t ofs, uint32_t value, size_t size) 
+{
+  for (; size > 0; size--, value >>= 8)
+    image[ofs++] = value;
+}
+
+/* Stores a read-only PT_LOAD program header at OFS in image for
+   FILESZ bytes at file offset 0 mapped at VADDR. */
+static void
+put_phdr (size_t ofs, uint32_t vaddr, uint32_t filesz, uint32_t flags) 
+{
+  put (ofs + 0, 1, 4);          /* p_type = PT_LOAD. */
+  put (ofs + 4, 0, 4);          /* p_offset. */
+  put (ofs + 8, vaddr, 4);      /* p_vaddr. */
+  put (ofs + 12, vaddr, 4);     /* p_paddr. */
+  put (ofs + 16, filesz, 4);    /* p_filesz. */
+  put (ofs + 20, filesz, 4);    /* p_memsz. */
+  put (ofs + 24, flags, 4);     /* p_flags. */
+  put (ofs + 28, 0x1000, 4);    /* p_align. */
+}
+
+void
+test_main (void) 
+{
+  /* Touches the second segment, then calls exit(42). */
+  static const uint8_t code[] =
+    {
+      0xa1, DATA_VADDR & 0xff, (DATA_VADDR >> 8) & 0xff,
+      (DATA_VADDR >> 16) & 0xff, DATA_VADDR >> 24, /* mov DATA_VADDR, %eax */
+      0x6a, 42,                                     /* push $42 */
+      0x6a, SYS_EXIT,                               /* push $SYS_EXIT */
+      0xcd, 0x30,                                   /* int $0x30 */
+    };
+  pid_t pid;
+  int fd;
+
+  /* ELF header. */
+  memcpy (image, "\177ELF\1\1\1", 7);
+  put (16, 2, 2);               /* e_type = ET_EXEC. */
+  put (18, 3, 2);               /* e_machine = EM_386. */
+  put (20, 1, 4);               /* e_version. */
+  put (24, TEXT_VADDR + CODE_OFS, 4); /* e_entry. */
+  put (28, 52, 4);              /* e_phoff. */
+  put (40, 52, 2);              /* e_ehsize. */
+  put (42, 32, 2);              /* e_phentsize. */
+  put (44, 2, 2);               /* e_phnum. */
+
+  /* Both segments start at file offset 0: the first covers the
+     code, the second only the headers. */
+  put_phdr (52, TEXT_VADDR, sizeof image, 5);   /* PF_R | PF_X. */
+  put_phdr (84, DATA_VADDR, 64, 4);             /* PF_R. */
+  memcpy (image + CODE_OFS, code, sizeof code);
+
+  CHECK (create ("overlap", sizeof image), "create \"overlap\"");
+  CHECK ((fd = open ("overlap")) > 1, "open \"overlap\"");
+  CHECK (write (fd, image, sizeof image) == sizeof image,
+         "write \"overlap\"");
+  close (fd);
+
+  pid = exec ("overlap");
+  CHECK (wait (pid) == 42, "exec and wait for \"overlap\"");
+}
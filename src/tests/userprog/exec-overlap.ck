@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(exec-overlap) begin
+(exec-overlap) create "overlap"
+(exec-overlap) open "overlap"
+(exec-overlap) write "overlap"
+overlap: exit(42)
+(exec-overlap) exec and wait for "overlap"
+(exec-overlap) end
+exec-overlap: exit(0)
+EOF
+pass;
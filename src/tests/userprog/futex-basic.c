@@ -0,0 +1,30 @@
+/* Checks the futex system calls and the user-space mutex built
+   on them, in a single thread: futex_wait() must return at once
+   if the word no longer holds the expected value, and also if it
+   does but no other thread could ever wake the caller;
+   futex_wake() must find no one to wake; and a mutex must lock
+   and unlock without blocking. */
+
+#include <mutex.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct mutex m;
+  int word = 1;
+
+  CHECK (futex_wait (&word, 0) == -1, "futex_wait on changed word");
+  CHECK (futex_wait (&word, 1) == -1, "futex_wait with no one to wake us");
+  CHECK (futex_wake (&word, 1) == 0, "futex_wake with no waiters");
+
+  mutex_init (&m);
+  mutex_lock (&m);
+  CHECK (!mutex_trylock (&m), "mutex_trylock on held mutex");
+  mutex_unlock (&m);
+  CHECK (mutex_trylock (&m), "mutex_trylock on free mutex");
+  mutex_unlock (&m);
+  CHECK (m.state == MUTEX_UNLOCKED, "mutex left unlocked");
+}
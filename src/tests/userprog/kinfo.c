@@ -0,0 +1,26 @@
+/* Reads the kernel info page: the clock must be calibrated, and
+   spinning until the tick count advances must show up in this
+   process's run time.  Then tries to write the page, which must
+   kill the process with exit code -1. */
+
+#include <kinfo.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct kinfo before, after;
+
+  kinfo_read (&before);
+  CHECK (before.tsc_hz > 0, "TSC frequency is known");
+
+  do
+    kinfo_read (&after);
+  while (after.ticks < before.ticks + 2);
+  CHECK (after.run_ticks > before.run_ticks, "run time advanced");
+  CHECK (after.seq % 2 == 0, "snapshot is consistent");
+
+  *(volatile int64_t *) &KINFO_ADDR->ticks = 0;
+  fail ("should have exited with -1");
+}
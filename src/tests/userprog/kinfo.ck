@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_USER_FAULTS => 1, [<<'EOF']);
+(kinfo) begin
+(kinfo) TSC frequency is known
+(kinfo) run time advanced
+(kinfo) snapshot is consistent
+kinfo: exit(-1)
+EOF
+pass;
@@ -0,0 +1,33 @@
+/* Puts a child process to sleep on a futex and wakes it.  The
+   child runs this same program, so the read-only page holding
+   WORD is a single frame mapped by both processes: the child
+   sleeps on WORD in futex_wait() until the parent finds it there
+   with futex_wake(). */
+
+#include <syscall.h>
+#include "tests/lib.h"
+
+const char *test_name = "futex-wake";
+
+/* In a read-only segment, shared by every process running this
+   program. */
+static const int word = 0x1234;
+
+int
+main (int argc, char *argv[] UNUSED) 
+{
+  pid_t child;
+  int code;
+
+  if (argc > 1)
+    return futex_wait ((int *) &word, 0x1234) == 0 ? 81 : -1;
+
+  msg ("begin");
+  CHECK ((child = exec ("futex-wake child")) != -1, "exec child");
+  while (futex_wake ((int *) &word, 1) == 0)
+    continue;
+  code = wait (child);
+  CHECK (code == 81, "child woken from futex_wait");
+  msg ("end");
+  return 0;
+}
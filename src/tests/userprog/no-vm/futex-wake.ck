@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(futex-wake) begin
+(futex-wake) exec child
+futex-wake: exit(81)
+(futex-wake) child woken from futex_wait
+(futex-wake) end
+futex-wake: exit(0)
+EOF
+pass;
@@ -0,0 +1,38 @@
+/* Opens and closes a file many more times than a process could
+   hold descriptors at once, then opens it enough times to make
+   the descriptor table grow.  Closed descriptors must be reused,
+   lowest first. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define OPEN_CNT 200
+
+void
+test_main (void) 
+{
+  int fds[OPEN_CNT];
+  int first, i;
+
+  CHECK ((first = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  close (first);
+
+  msg ("open and close 2000 times");
+  for (i = 0; i < 2000; i++) 
+    {
+      int fd = open ("sample.txt");
+      if (fd != first)
+        fail ("open returned %d, not %d", fd, first);
+      close (fd);
+    }
+
+  msg ("open %d times at once", OPEN_CNT);
+  for (i = 0; i < OPEN_CNT; i++) 
+    if ((fds[i] = open ("sample.txt")) != first + i)
+      fail ("open returned %d, not %d", fds[i], first + i);
+
+  close (fds[OPEN_CNT / 2]);
+  CHECK (open ("sample.txt") == fds[OPEN_CNT / 2],
+         "reopen gets the freed descriptor");
+}
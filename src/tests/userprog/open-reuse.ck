@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(open-reuse) begin
+(open-reuse) open "sample.txt"
+(open-reuse) open and close 2000 times
+(open-reuse) open 200 times at once
+(open-reuse) reopen gets the freed descriptor
+(open-reuse) end
+open-reuse: exit(0)
+EOF
+pass;
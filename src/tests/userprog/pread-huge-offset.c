@@ -0,0 +1,27 @@
+/* Passes pread() and pwrite() offsets at and beyond 2**31, and
+   ranges that cross it, which must all fail with -1 without
+   touching the disk, then checks that "sample.txt" is intact. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  static char buf[512];
+  int fd;
+
+  CHECK ((fd = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (pwrite (fd, buf, sizeof buf, 0xfffffe00) == -1,
+         "pwrite at offset 0xfffffe00");
+  CHECK (pread (fd, buf, sizeof buf, 0xfffffe00) == -1,
+         "pread at offset 0xfffffe00");
+  CHECK (pread (fd, buf, 1, 0x80000000) == -1, "pread at offset 0x80000000");
+  CHECK (pwrite (fd, buf, sizeof buf, 0x7fffff00) == -1,
+         "pwrite across offset 0x7fffffff");
+  close (fd);
+
+  check_file ("sample.txt", sample, sizeof sample - 1);
+}
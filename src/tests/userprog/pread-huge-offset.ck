@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pread-huge-offset) begin
+(pread-huge-offset) open "sample.txt"
+(pread-huge-offset) pwrite at offset 0xfffffe00
+(pread-huge-offset) pread at offset 0xfffffe00
+(pread-huge-offset) pread at offset 0x80000000
+(pread-huge-offset) pwrite across offset 0x7fffffff
+(pread-huge-offset) open "sample.txt" for verification
+(pread-huge-offset) verified contents of "sample.txt"
+(pread-huge-offset) close "sample.txt"
+(pread-huge-offset) end
+pread-huge-offset: exit(0)
+EOF
+pass;
@@ -0,0 +1,33 @@
+/* Reads and writes "sample.txt" at explicit offsets with pread()
+   and pwrite(), and checks that neither moves the file position
+   that read(), write() and tell() use. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  static const char patch[] = "PATCH";
+  char buf[32];
+  int fd;
+
+  CHECK ((fd = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  seek (fd, 3);
+
+  CHECK (pread (fd, buf, sizeof buf, 20) == sizeof buf, "pread at offset 20");
+  compare_bytes (buf, sample + 20, sizeof buf, 20, "sample.txt");
+  CHECK (tell (fd) == 3, "pread leaves position alone");
+
+  CHECK (pwrite (fd, patch, 5, 40) == 5, "pwrite at offset 40");
+  CHECK (tell (fd) == 3, "pwrite leaves position alone");
+  CHECK (pread (fd, buf, 5, 40) == 5, "pread back");
+  compare_bytes (buf, patch, 5, 40, "sample.txt");
+
+  CHECK (pread (fd, buf, sizeof buf, sizeof sample - 11) == 10,
+         "pread short at end of file");
+  CHECK (pread (123456, buf, 1, 0) == -1, "pread of bad descriptor");
+}
@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pread-pwrite) begin
+(pread-pwrite) open "sample.txt"
+(pread-pwrite) pread at offset 20
+(pread-pwrite) pread leaves position alone
+(pread-pwrite) pwrite at offset 40
+(pread-pwrite) pwrite leaves position alone
+(pread-pwrite) pread back
+(pread-pwrite) pread short at end of file
+(pread-pwrite) pread of bad descriptor
+(pread-pwrite) end
+pread-pwrite: exit(0)
+EOF
+pass;
@@ -0,0 +1,18 @@
+/* Passes a pointer into the read-only code segment to the read
+   system call.  The buffer must be found to be unwritable before
+   anything is read into it, and the process must be terminated
+   with -1 exit code. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  int handle;
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+
+  read (handle, (char *) test_main, 123);
+  fail ("should not have survived read()");
+}
@@ -0,0 +1,45 @@
+/* Reads "sample.txt" into three buffers with one readv() call,
+   writes them back to a new file with one writev() call, and
+   checks the result. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char a[7], b[64], c[sizeof sample];
+  struct iovec iov[3];
+  size_t size = sizeof sample - 1;
+  int fd;
+
+  iov[0].iov_base = a;
+  iov[0].iov_len = sizeof a;
+  iov[1].iov_base = b;
+  iov[1].iov_len = sizeof b;
+  iov[2].iov_base = c;
+  iov[2].iov_len = sizeof c;
+
+  CHECK ((fd = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (readv (fd, iov, 3) == (int) size, "readv into 3 buffers");
+  compare_bytes (a, sample, sizeof a, 0, "sample.txt");
+  compare_bytes (b, sample + sizeof a, sizeof b, sizeof a, "sample.txt");
+  compare_bytes (c, sample + sizeof a + sizeof b,
+                 size - sizeof a - sizeof b, sizeof a + sizeof b,
+                 "sample.txt");
+  CHECK (readv (fd, iov, IOV_MAX + 1) == -1, "readv of too many buffers");
+  CHECK (readv (fd, iov, -1) == -1, "readv of -1 buffers");
+  close (fd);
+
+  iov[2].iov_len = size - sizeof a - sizeof b;
+  CHECK (create ("copy.txt", size), "create \"copy.txt\"");
+  CHECK ((fd = open ("copy.txt")) > 1, "open \"copy.txt\"");
+  CHECK (writev (fd, iov, 3) == (int) size, "writev from 3 buffers");
+  CHECK (tell (fd) == size, "writev advances position");
+  close (fd);
+
+  check_file ("copy.txt", sample, size);
+}
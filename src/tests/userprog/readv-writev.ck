@@ -0,0 +1,21 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(readv-writev) begin
+(readv-writev) open "sample.txt"
+(readv-writev) readv into 3 buffers
+(readv-writev) readv of too many buffers
+(readv-writev) readv of -1 buffers
+(readv-writev) create "copy.txt"
+(readv-writev) open "copy.txt"
+(readv-writev) writev from 3 buffers
+(readv-writev) writev advances position
+(readv-writev) open "copy.txt" for verification
+(readv-writev) verified contents of "copy.txt"
+(readv-writev) close "copy.txt"
+(readv-writev) end
+readv-writev: exit(0)
+EOF
+pass;
@@ -0,0 +1,39 @@
+/* Sets the nested task flag immediately before a SYSENTER that
+   waits for a child process, so that the kernel blocks and
+   switches threads while the flag would still be live if it did
+   not clear it.  The kernel must not let NT reach an IRET, must
+   complete the wait, and must return with NT clear. */
+
+#include <syscall.h>
+#include <syscall-nr.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  pid_t child;
+  int status;
+  unsigned int flags;
+
+  if (!syscall_use_sysenter (true))
+    fail ("CPU does not support sysenter");
+
+  CHECK ((child = exec ("child-simple")) != -1, "exec(\"child-simple\")");
+  asm volatile ("pushl %[child]\n\t"
+                "pushl %[number]\n\t"
+                "movl $1f, %%edx\n\t"
+                "movl %%esp, %%ecx\n\t"
+                "pushfl\n\t"
+                "orl $0x4000, (%%esp)\n\t"
+                "popfl\n\t"
+                "sysenter\n"
+                "1:\taddl $8, %%esp\n\t"
+                "pushfl\n\t"
+                "popl %[flags]"
+                : "=a" (status), [flags] "=r" (flags)
+                : [child] "r" (child), [number] "i" (SYS_WAIT)
+                : "ecx", "edx", "memory", "cc");
+  CHECK (status == 81, "wait(exec()) returned %d", status);
+  CHECK ((flags & 0x4000) == 0, "NT clear after sysenter");
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(sysenter-nt) begin
+(sysenter-nt) exec("child-simple")
+(child-simple) run
+child-simple: exit(81)
+(sysenter-nt) wait(exec()) returned 81
+(sysenter-nt) NT clear after sysenter
+(sysenter-nt) end
+sysenter-nt: exit(0)
+EOF
+pass;
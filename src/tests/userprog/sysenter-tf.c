@@ -0,0 +1,32 @@
+/* Sets the trap flag immediately before SYSENTER.  SYSENTER does
+   not clear TF, so the kernel takes a single-step trap on its
+   entry point.  It must absorb the trap, complete the system
+   call, and return with TF clear, rather than panic. */
+
+#include <syscall.h>
+#include <syscall-nr.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  int sum;
+
+  if (!syscall_use_sysenter (true))
+    fail ("CPU does not support sysenter");
+
+  asm volatile ("pushl $4; pushl $3; pushl $2; pushl $1\n\t"
+                "pushl %[number]\n\t"
+                "movl $1f, %%edx\n\t"
+                "movl %%esp, %%ecx\n\t"
+                "pushfl\n\t"
+                "orl $0x100, (%%esp)\n\t"
+                "popfl\n\t"
+                "sysenter\n"
+                "1:\taddl $20, %%esp"
+                : "=a" (sum)
+                : [number] "i" (SYS_SUMFOUR)
+                : "ecx", "edx", "memory", "cc");
+  CHECK (sum == 10, "sumFour returned %d", sum);
+}
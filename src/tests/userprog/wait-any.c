@@ -0,0 +1,53 @@
+/* Starts several children at once and reaps them with
+   wait_any(), in whatever order they finish, then checks
+   waitpid() with WNOHANG. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define CHILD_CNT 3
+
+void
+test_main (void) 
+{
+  pid_t pids[CHILD_CNT], pid;
+  bool reaped[CHILD_CNT];
+  int status, i;
+
+  /* Children run as soon as they are started, so say nothing
+     until they are all reaped, to keep the output in order. */
+  for (i = 0; i < CHILD_CNT; i++) 
+    {
+      pids[i] = exec ("child-simple");
+      if (pids[i] == PID_ERROR)
+        fail ("exec \"child-simple\" failed");
+      reaped[i] = false;
+    }
+  for (i = 0; i < CHILD_CNT; i++) 
+    {
+      int j;
+
+      pid = wait_any (&status);
+      for (j = 0; j < CHILD_CNT; j++)
+        if (pids[j] == pid && !reaped[j])
+          break;
+      if (j == CHILD_CNT)
+        fail ("wait_any returned unexpected pid %d", pid);
+      if (status != 81)
+        fail ("child %d exited with %d, not 81", pid, status);
+      reaped[j] = true;
+    }
+  msg ("wait_any reaped %d children", CHILD_CNT);
+  CHECK (wait_any (&status) == -1, "wait_any with no children");
+
+  pid = exec ("child-simple");
+  if (pid == PID_ERROR)
+    fail ("exec \"child-simple\" failed");
+  while ((i = waitpid (pid, &status, WNOHANG)) == 0)
+    continue;
+  if (i != pid || status != 81)
+    fail ("waitpid returned %d with status %d", i, status);
+  msg ("waitpid WNOHANG");
+  CHECK (waitpid (pid, &status, WNOHANG) == -1, "waitpid of reaped child");
+}
@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(wait-any) begin
+(child-simple) run
+(child-simple) run
+(child-simple) run
+(wait-any) wait_any reaped 3 children
+(wait-any) wait_any with no children
+(child-simple) run
+(wait-any) waitpid WNOHANG
+(wait-any) waitpid of reaped child
+(wait-any) end
+EOF
+pass;
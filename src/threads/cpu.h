@@ -0,0 +1,34 @@
+#ifndef THREADS_CPU_H
+#define THREADS_CPU_H
+
+#include <stdint.h>
+
+/* Returns the processor's time-stamp counter, which counts CPU
+   cycles since reset. */
+static inline uint64_t
+rdtsc (void) 
+{
+  uint64_t tsc;
+  asm volatile ("rdtsc" : "=A" (tsc));
+  return tsc;
+}
+
+/* Executes CPUID with EAX = LEAF and stores the four result
+   registers in REGS[0...3], in the order EAX, EBX, ECX, EDX. */
+static inline void
+cpuid (uint32_t leaf, uint32_t regs[4]) 
+{
+  asm volatile ("cpuid"
+                : "=a" (regs[0]), "=b" (regs[1]),
+                  "=c" (regs[2]), "=d" (regs[3])
+                : "a" (leaf));
+}
+
+/* Writes VALUE to model-specific register MSR. */
+static inline void
+wrmsr (uint32_t msr, uint64_t value) 
+{
+  asm volatile ("wrmsr" : : "c" (msr), "A" (value));
+}
+
+#endif /* threads/cpu.h */
@@ -27,6 +27,7 @@
 #include "userprog/exception.h"
 #include "userprog/gdt.h"
 #include "userprog/syscall.h"
+#include "userprog/textcache.h"
 #include "userprog/tss.h"
 #else
 #include "tests/threads/tests.h"
@@ -113,6 +114,8 @@ main (void)
 #ifdef USERPROG
   exception_init ();
   syscall_init ();
+  textcache_init ();
+  process_init ();
 #endif
 
   /* Start thread scheduler and enable interrupts. */
@@ -256,6 +259,12 @@ parse_options (char **argv)
         random_init (atoi (value));
       else if (!strcmp (name, "-mlfqs"))
         thread_mlfqs = true;
+      else if (!strcmp (name, "-stride"))
+        thread_stride = true;
+      else if (!strcmp (name, "-tickless"))
+        timer_tickless = true;
+      else if (!strcmp (name, "-intr-stats"))
+        intr_stats = true;
 #ifndef USERPROG
 	  else if (!strcmp (name, "-aging"))
 		thread_prior_aging = true;
@@ -267,6 +276,8 @@ parse_options (char **argv)
       else
         PANIC ("unknown option `%s' (use -h for help)", name);
     }
+  if (thread_mlfqs && thread_stride)
+    PANIC ("-mlfqs and -stride are mutually exclusive");
 
   /* Initialize the random number generator based on the system
      time.  This has no effect if an "-rs" option was specified.
@@ -383,6 +394,9 @@ usage (void)
 #endif
           "  -rs=SEED           Set random number seed to SEED.\n"
           "  -mlfqs             Use multi-level feedback queue scheduler.\n"
+          "  -stride            Use stride (proportional-share) scheduler.\n"
+          "  -tickless          Stop the periodic timer while idle.\n"
+          "  -intr-stats        Time the longest interrupts-off interval.\n"
 #ifdef USERPROG
           "  -ul=COUNT          Limit user memory to COUNT pages.\n"
 #endif
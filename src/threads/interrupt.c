@@ -3,6 +3,7 @@
 #include <inttypes.h>
 #include <stdint.h>
 #include <stdio.h>
+#include "threads/cpu.h"
 #include "threads/flags.h"
 #include "threads/intr-stubs.h"
 #include "threads/io.h"
@@ -47,6 +48,18 @@ static unsigned int unexpected_cnt[INTR_CNT];
 static bool in_external_intr;   /* Are we processing an external interrupt? */
 static bool yield_on_return;    /* Should we yield on interrupt return? */
 
+/* Time interrupts-off intervals?  Controlled by kernel
+   command-line option "-intr-stats". */
+bool intr_stats;
+
+/* Longest stretch, in CPU cycles, spent with interrupts off.
+   intr_off_tsc is the time-stamp counter when interrupts were
+   last turned off, or 0 while they are on or not being timed. */
+static uint64_t intr_off_tsc;
+static uint64_t intr_off_max;
+
+static inline void intr_off_begin (void);
+
 /* Programmable Interrupt Controller helpers. */
 static void pic_init (void);
 static void pic_end_of_interrupt (int irq);
@@ -90,6 +103,9 @@ intr_enable (void)
   enum intr_level old_level = intr_get_level ();
   ASSERT (!intr_context ());
 
+  if (old_level == INTR_OFF)
+    intr_note_enable ();
+
   /* Enable interrupts by setting the interrupt flag.
 
      See [IA32-v2b] "STI" and [IA32-v3a] 5.8.1 "Masking Maskable
@@ -110,8 +126,44 @@ intr_disable (void)
      Hardware Interrupts". */
   asm volatile ("cli" : : : "memory");
 
+  if (old_level == INTR_ON)
+    intr_off_begin ();
+
   return old_level;
 }
+
+/* Notes that interrupts went off just now. */
+static inline void
+intr_off_begin (void) 
+{
+  if (intr_stats)
+    intr_off_tsc = rdtsc ();
+}
+
+/* Notes that interrupts are about to be turned back on, ending
+   the interval started by intr_off_begin().  Code that turns
+   interrupts on without calling intr_enable(), such as the idle
+   loop and sysenter_entry, must call this first. */
+void
+intr_note_enable (void) 
+{
+  if (intr_off_tsc != 0) 
+    {
+      uint64_t off = rdtsc () - intr_off_tsc;
+      if (off > intr_off_max)
+        intr_off_max = off;
+      intr_off_tsc = 0;
+    }
+}
+
+/* Prints interrupt statistics, if they were kept. */
+void
+intr_print_stats (void) 
+{
+  if (intr_stats)
+    printf ("Interrupts: at most %"PRIu64" cycles with interrupts off\n",
+            intr_off_max);
+}
 
 /* Initializes the interrupt system. */
 void
@@ -357,6 +409,7 @@ intr_handler (struct intr_frame *frame)
       ASSERT (intr_get_level () == INTR_OFF);
       ASSERT (!intr_context ());
 
+      intr_off_begin ();
       in_external_intr = true;
       yield_on_return = false;
     }
@@ -385,6 +438,11 @@ intr_handler (struct intr_frame *frame)
 
       if (yield_on_return) 
         thread_yield (); 
+
+      /* Interrupts come back on when intr_exit returns.  Noting
+         that only now counts any switch to another thread
+         above in the interval. */
+      intr_note_enable ();
     }
 }
 
@@ -11,10 +11,15 @@ enum intr_level
     INTR_ON               /* Interrupts enabled. */
   };
 
+/* Interrupts-off timing, set by "-intr-stats". */
+extern bool intr_stats;
+
 enum intr_level intr_get_level (void);
 enum intr_level intr_set_level (enum intr_level);
 enum intr_level intr_enable (void);
 enum intr_level intr_disable (void);
+void intr_note_enable (void);
+void intr_print_stats (void);
 
 /* Interrupt stack frame. */
 struct intr_frame
@@ -32,6 +32,22 @@
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 
+/* Maximum length of a chain of nested donations.  A donation
+   that reaches a thread waiting on a lock is passed on to that
+   lock's holder, and so on, for at most this many locks. */
+#define DONATION_DEPTH_MAX 8
+
+static void lock_donate (struct lock *, int priority);
+static int sema_max_priority (struct semaphore *);
+static bool sema_waiter_less (const struct heap_elem *,
+                              const struct heap_elem *, void *aux);
+static bool cond_waiter_less (const struct heap_elem *,
+                              const struct heap_elem *, void *aux);
+
+/* Stamps each new waiter on a semaphore or condition variable,
+   so that waiters of equal priority are woken in FIFO order. */
+static uint64_t wait_seq;
+
 /* Initializes semaphore SEMA to VALUE.  A semaphore is a
    nonnegative integer along with two atomic operators for
    manipulating it:
@@ -47,7 +63,7 @@ sema_init (struct semaphore *sema, unsigned value)
   ASSERT (sema != NULL);
 
   sema->value = value;
-  list_init (&sema->waiters);
+  heap_init (&sema->waiters, sema_waiter_less, NULL);
 }
 
 /* Down or "P" operation on a semaphore.  Waits for SEMA's value
@@ -68,9 +84,19 @@ sema_down (struct semaphore *sema)
   old_level = intr_disable ();
   while (sema->value == 0) 
     {
-	  list_insert_ordered(&sema->waiters, &thread_current()->elem,
-		                  priority_comp, NULL);
-      //list_push_back (&sema->waiters, &thread_current ()->elem);
+      struct thread *cur = thread_current ();
+
+      cur->wait_seq = wait_seq++;
+      heap_push (&sema->waiters, &cur->wait_elem);
+
+      /* A thread in cond_wait() is also the only waiter on its
+         own semaphore, where order does not matter; it is kept
+         in order in the condition variable's queue instead. */
+      if (cur->wait_queue == NULL)
+        {
+          cur->wait_queue = &sema->waiters;
+          cur->wait_queue_elem = &cur->wait_elem;
+        }
       thread_block ();
     }
   sema->value--;
@@ -104,7 +130,12 @@ sema_try_down (struct semaphore *sema)
 }
 
 /* Up or "V" operation on a semaphore.  Increments SEMA's value
-   and wakes up one thread of those waiting for SEMA, if any.
+   and wakes up the highest-priority thread of those waiting for
+   SEMA, if any, and yields to it if it outranks the running
+   thread.  Waiters of equal priority are woken in FIFO order.
+   A waiter whose priority changes while it waits is moved within
+   the queue (see thread_set_ready_priority()), so the front of
+   the queue is always right.
 
    This function may be called from an interrupt handler. */
 void
@@ -115,16 +146,47 @@ sema_up (struct semaphore *sema)
   ASSERT (sema != NULL);
 
   old_level = intr_disable ();
-  if (!list_empty (&sema->waiters)) 
-    thread_unblock (list_entry (list_pop_front (&sema->waiters),
-                                struct thread, elem));
+  if (!heap_empty (&sema->waiters)) 
+    {
+      struct thread *t = heap_entry (heap_pop (&sema->waiters),
+                                     struct thread, wait_elem);
+      if (t->wait_queue == &sema->waiters)
+        t->wait_queue = NULL;
+      thread_unblock (t);
+    }
   sema->value++;
-#ifndef USERPROG
-  thread_yield();
-#endif
+  thread_preempt ();
   intr_set_level (old_level);
 }
 
+/* Returns the highest priority among the threads waiting for
+   SEMA, or PRI_MIN - 1 if there are none.  Interrupts must be
+   off. */
+static int
+sema_max_priority (struct semaphore *sema) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (heap_empty (&sema->waiters))
+    return PRI_MIN - 1;
+  return heap_entry (heap_min (&sema->waiters),
+                     struct thread, wait_elem)->priority;
+}
+
+/* Orders threads waiting on a semaphore: higher priority first,
+   then first come, first served. */
+static bool
+sema_waiter_less (const struct heap_elem *a_, const struct heap_elem *b_,
+                  void *aux UNUSED) 
+{
+  const struct thread *a = heap_entry (a_, struct thread, wait_elem);
+  const struct thread *b = heap_entry (b_, struct thread, wait_elem);
+
+  if (a->priority != b->priority)
+    return a->priority > b->priority;
+  return a->wait_seq < b->wait_seq;
+}
+
 static void sema_test_helper (void *sema_);
 
 /* Self-test for semaphores that makes control "ping-pong"
@@ -184,6 +246,7 @@ lock_init (struct lock *lock)
 
   lock->holder = NULL;
   sema_init (&lock->semaphore, 1);
+  lock->priority = PRI_MIN - 1;
 }
 
 /* Acquires LOCK, sleeping until it becomes available if
@@ -197,12 +260,56 @@ lock_init (struct lock *lock)
 void
 lock_acquire (struct lock *lock)
 {
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+
   ASSERT (lock != NULL);
   ASSERT (!intr_context ());
   ASSERT (!lock_held_by_current_thread (lock));
 
+  old_level = intr_disable ();
+  if (lock->holder != NULL && !thread_mlfqs)
+    {
+      /* Lend our priority to the holder, and on down the chain
+         of locks it is waiting for. */
+      cur->waiting_lock = lock;
+      lock_donate (lock, cur->priority);
+    }
   sema_down (&lock->semaphore);
-  lock->holder = thread_current ();
+  cur->waiting_lock = NULL;
+  lock->holder = cur;
+
+  /* Threads still waiting now donate to us. */
+  list_push_back (&cur->held_locks, &lock->elem);
+  lock->priority = sema_max_priority (&lock->semaphore);
+  if (!thread_mlfqs && lock->priority > cur->priority)
+    thread_set_ready_priority (cur, lock->priority);
+  intr_set_level (old_level);
+}
+
+/* Donates PRIORITY to the holder of LOCK.  If that holder is
+   itself waiting for a lock, the donation is passed on to that
+   lock's holder, and so on, up to DONATION_DEPTH_MAX locks deep.
+   Stops as soon as a holder already has at least PRIORITY.
+   Interrupts must be off. */
+static void
+lock_donate (struct lock *lock, int priority) 
+{
+  int depth;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  for (depth = 0; lock != NULL && depth < DONATION_DEPTH_MAX; depth++)
+    {
+      struct thread *holder = lock->holder;
+
+      if (lock->priority < priority)
+        lock->priority = priority;
+      if (holder == NULL || holder->priority >= priority)
+        break;
+      thread_set_ready_priority (holder, priority);
+      lock = holder->waiting_lock;
+    }
 }
 
 /* Tries to acquires LOCK and returns true if successful or false
@@ -221,7 +328,13 @@ lock_try_acquire (struct lock *lock)
 
   success = sema_try_down (&lock->semaphore);
   if (success)
-    lock->holder = thread_current ();
+    {
+      enum intr_level old_level = intr_disable ();
+      lock->holder = thread_current ();
+      list_push_back (&lock->holder->held_locks, &lock->elem);
+      lock->priority = PRI_MIN - 1;
+      intr_set_level (old_level);
+    }
   return success;
 }
 
@@ -233,11 +346,21 @@ lock_try_acquire (struct lock *lock)
 void
 lock_release (struct lock *lock) 
 {
+  enum intr_level old_level;
+
   ASSERT (lock != NULL);
   ASSERT (lock_held_by_current_thread (lock));
 
+  /* Give back what was donated through LOCK.  What is still
+     donated through other locks we hold stays. */
+  old_level = intr_disable ();
+  list_remove (&lock->elem);
   lock->holder = NULL;
+  lock->priority = PRI_MIN - 1;
+  if (!thread_mlfqs)
+    thread_refresh_priority (thread_current ());
   sema_up (&lock->semaphore);
+  intr_set_level (old_level);
 }
 
 /* Returns true if the current thread holds LOCK, false
@@ -254,8 +377,10 @@ lock_held_by_current_thread (const struct lock *lock)
 /* One semaphore in a list. */
 struct semaphore_elem 
   {
-    struct list_elem elem;              /* List element. */
+    struct heap_elem elem;              /* Heap element. */
     struct semaphore semaphore;         /* This semaphore. */
+    struct thread *thread;              /* Thread waiting on it. */
+    uint64_t seq;                       /* Order of arrival. */
   };
 
 /* Initializes condition variable COND.  A condition variable
@@ -266,7 +391,7 @@ cond_init (struct condition *cond)
 {
   ASSERT (cond != NULL);
 
-  list_init (&cond->waiters);
+  heap_init (&cond->waiters, cond_waiter_less, NULL);
 }
 
 /* Atomically releases LOCK and waits for COND to be signaled by
@@ -293,6 +418,8 @@ void
 cond_wait (struct condition *cond, struct lock *lock) 
 {
   struct semaphore_elem waiter;
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
 
   ASSERT (cond != NULL);
   ASSERT (lock != NULL);
@@ -300,7 +427,13 @@ cond_wait (struct condition *cond, struct lock *lock)
   ASSERT (lock_held_by_current_thread (lock));
   
   sema_init (&waiter.semaphore, 0);
-  list_push_back (&cond->waiters, &waiter.elem);
+  waiter.thread = cur;
+  old_level = intr_disable ();
+  waiter.seq = wait_seq++;
+  heap_push (&cond->waiters, &waiter.elem);
+  cur->wait_queue = &cond->waiters;
+  cur->wait_queue_elem = &waiter.elem;
+  intr_set_level (old_level);
   lock_release (lock);
   sema_down (&waiter.semaphore);
   lock_acquire (lock);
@@ -321,9 +454,34 @@ cond_signal (struct condition *cond, struct lock *lock UNUSED)
   ASSERT (!intr_context ());
   ASSERT (lock_held_by_current_thread (lock));
 
-  if (!list_empty (&cond->waiters)) 
-    sema_up (&list_entry (list_pop_front (&cond->waiters),
-                          struct semaphore_elem, elem)->semaphore);
+  if (!heap_empty (&cond->waiters)) 
+    {
+      struct semaphore_elem *waiter;
+      enum intr_level old_level;
+
+      old_level = intr_disable ();
+      waiter = heap_entry (heap_pop (&cond->waiters),
+                           struct semaphore_elem, elem);
+      waiter->thread->wait_queue = NULL;
+      intr_set_level (old_level);
+      sema_up (&waiter->semaphore);
+    }
+}
+
+/* Orders threads waiting on a condition variable: higher
+   priority first, then first come, first served. */
+static bool
+cond_waiter_less (const struct heap_elem *a_, const struct heap_elem *b_,
+                  void *aux UNUSED) 
+{
+  const struct semaphore_elem *a = heap_entry (a_, struct semaphore_elem,
+                                               elem);
+  const struct semaphore_elem *b = heap_entry (b_, struct semaphore_elem,
+                                               elem);
+
+  if (a->thread->priority != b->thread->priority)
+    return a->thread->priority > b->thread->priority;
+  return a->seq < b->seq;
 }
 
 /* Wakes up all threads, if any, waiting on COND (protected by
@@ -338,6 +496,231 @@ cond_broadcast (struct condition *cond, struct lock *lock)
   ASSERT (cond != NULL);
   ASSERT (lock != NULL);
 
-  while (!list_empty (&cond->waiters))
+  while (!heap_empty (&cond->waiters))
     cond_signal (cond, lock);
 }
+
+/* Initializes RWLOCK.  A reader-writer lock can be held either
+   shared, by any number of threads at once, or exclusive, by a
+   single thread.
+
+   Writers are preferred: once a thread is waiting to acquire
+   RWLOCK exclusive, new shared acquisitions wait until it has
+   had its turn, so a steady stream of readers cannot starve
+   writers. */
+void
+rwlock_init (struct rwlock *rwlock) 
+{
+  ASSERT (rwlock != NULL);
+
+  lock_init (&rwlock->lock);
+  cond_init (&rwlock->readers_ok);
+  cond_init (&rwlock->writers_ok);
+  cond_init (&rwlock->upgrade_ok);
+  rwlock->readers = 0;
+  rwlock->writer = NULL;
+  rwlock->waiting_writers = 0;
+  rwlock->upgrading = false;
+}
+
+/* Returns true if a thread asking for RWLOCK shared must wait.
+   RWLOCK's internal lock must be held. */
+static bool
+rwlock_readers_wait (const struct rwlock *rwlock) 
+{
+  return (rwlock->writer != NULL || rwlock->waiting_writers > 0
+          || rwlock->upgrading);
+}
+
+/* Returns true if a thread asking for RWLOCK exclusive must
+   wait.  RWLOCK's internal lock must be held. */
+static bool
+rwlock_writers_wait (const struct rwlock *rwlock) 
+{
+  return (rwlock->writer != NULL || rwlock->readers > 0
+          || rwlock->upgrading);
+}
+
+/* Hands RWLOCK to whoever should have it next, now that it might
+   be free.  A pending upgrade comes first, then a writer, and
+   only then readers.  RWLOCK's internal lock must be held. */
+static void
+rwlock_wake (struct rwlock *rwlock) 
+{
+  if (rwlock->writer != NULL)
+    return;
+  if (rwlock->upgrading)
+    {
+      if (rwlock->readers == 0)
+        cond_signal (&rwlock->upgrade_ok, &rwlock->lock);
+    }
+  else if (rwlock->waiting_writers > 0)
+    {
+      if (rwlock->readers == 0)
+        cond_signal (&rwlock->writers_ok, &rwlock->lock);
+    }
+  else
+    cond_broadcast (&rwlock->readers_ok, &rwlock->lock);
+}
+
+/* Acquires RWLOCK shared, sleeping until no thread holds or is
+   waiting to acquire it exclusive.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void
+rwlock_acquire_shared (struct rwlock *rwlock) 
+{
+  ASSERT (rwlock != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (rwlock->writer != thread_current ());
+
+  lock_acquire (&rwlock->lock);
+  while (rwlock_readers_wait (rwlock))
+    cond_wait (&rwlock->readers_ok, &rwlock->lock);
+  rwlock->readers++;
+  lock_release (&rwlock->lock);
+}
+
+/* Tries to acquire RWLOCK shared without sleeping.  Returns true
+   if successful, false on failure, including when another thread
+   is inside RWLOCK's internal lock. */
+bool
+rwlock_try_acquire_shared (struct rwlock *rwlock) 
+{
+  bool success;
+
+  ASSERT (rwlock != NULL);
+
+  if (!lock_try_acquire (&rwlock->lock))
+    return false;
+  success = !rwlock_readers_wait (rwlock);
+  if (success)
+    rwlock->readers++;
+  lock_release (&rwlock->lock);
+  return success;
+}
+
+/* Releases RWLOCK, which the current thread must hold shared. */
+void
+rwlock_release_shared (struct rwlock *rwlock) 
+{
+  ASSERT (rwlock != NULL);
+
+  lock_acquire (&rwlock->lock);
+  ASSERT (rwlock->readers > 0);
+  rwlock->readers--;
+  rwlock_wake (rwlock);
+  lock_release (&rwlock->lock);
+}
+
+/* Acquires RWLOCK exclusive, sleeping until no other thread
+   holds it.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void
+rwlock_acquire_exclusive (struct rwlock *rwlock) 
+{
+  ASSERT (rwlock != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (rwlock->writer != thread_current ());
+
+  lock_acquire (&rwlock->lock);
+  rwlock->waiting_writers++;
+  while (rwlock_writers_wait (rwlock))
+    cond_wait (&rwlock->writers_ok, &rwlock->lock);
+  rwlock->waiting_writers--;
+  rwlock->writer = thread_current ();
+  lock_release (&rwlock->lock);
+}
+
+/* Tries to acquire RWLOCK exclusive without sleeping.  Returns
+   true if successful, false on failure, including when another
+   thread is inside RWLOCK's internal lock. */
+bool
+rwlock_try_acquire_exclusive (struct rwlock *rwlock) 
+{
+  bool success;
+
+  ASSERT (rwlock != NULL);
+
+  if (!lock_try_acquire (&rwlock->lock))
+    return false;
+  success = !rwlock_writers_wait (rwlock);
+  if (success)
+    rwlock->writer = thread_current ();
+  lock_release (&rwlock->lock);
+  return success;
+}
+
+/* Releases RWLOCK, which the current thread must hold
+   exclusive. */
+void
+rwlock_release_exclusive (struct rwlock *rwlock) 
+{
+  ASSERT (rwlock_held_exclusive (rwlock));
+
+  lock_acquire (&rwlock->lock);
+  rwlock->writer = NULL;
+  rwlock_wake (rwlock);
+  lock_release (&rwlock->lock);
+}
+
+/* Turns the current thread's shared hold on RWLOCK into an
+   exclusive one, sleeping until the other readers are gone.  The
+   upgrade goes ahead of threads already waiting for exclusive
+   access.
+
+   Only one upgrade can be pending at a time, since two readers
+   upgrading would each wait for the other.  If another thread is
+   already upgrading, returns false at once and the current
+   thread still holds RWLOCK shared; otherwise returns true. */
+bool
+rwlock_upgrade (struct rwlock *rwlock) 
+{
+  ASSERT (rwlock != NULL);
+  ASSERT (!intr_context ());
+
+  lock_acquire (&rwlock->lock);
+  ASSERT (rwlock->readers > 0);
+  if (rwlock->upgrading)
+    {
+      lock_release (&rwlock->lock);
+      return false;
+    }
+  rwlock->upgrading = true;
+  rwlock->readers--;
+  while (rwlock->readers > 0)
+    cond_wait (&rwlock->upgrade_ok, &rwlock->lock);
+  rwlock->upgrading = false;
+  rwlock->writer = thread_current ();
+  lock_release (&rwlock->lock);
+  return true;
+}
+
+/* Turns the current thread's exclusive hold on RWLOCK into a
+   shared one, letting waiting readers in unless a writer is
+   also waiting. */
+void
+rwlock_downgrade (struct rwlock *rwlock) 
+{
+  ASSERT (rwlock_held_exclusive (rwlock));
+
+  lock_acquire (&rwlock->lock);
+  rwlock->writer = NULL;
+  rwlock->readers++;
+  if (rwlock->waiting_writers == 0)
+    cond_broadcast (&rwlock->readers_ok, &rwlock->lock);
+  lock_release (&rwlock->lock);
+}
+
+/* Returns true if the current thread holds RWLOCK exclusive,
+   false otherwise. */
+bool
+rwlock_held_exclusive (const struct rwlock *rwlock) 
+{
+  ASSERT (rwlock != NULL);
+
+  return rwlock->writer == thread_current ();
+}
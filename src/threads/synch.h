@@ -1,6 +1,7 @@
 #ifndef THREADS_SYNCH_H
 #define THREADS_SYNCH_H
 
+#include <heap.h>
 #include <list.h>
 #include <stdbool.h>
 
@@ -8,7 +9,7 @@
 struct semaphore 
   {
     unsigned value;             /* Current value. */
-    struct list waiters;        /* List of waiting threads. */
+    struct heap waiters;        /* Waiting threads, by priority. */
   };
 
 void sema_init (struct semaphore *, unsigned value);
@@ -20,8 +21,10 @@ void sema_self_test (void);
 /* Lock. */
 struct lock 
   {
-    struct thread *holder;      /* Thread holding lock (for debugging). */
+    struct thread *holder;      /* Thread holding lock. */
     struct semaphore semaphore; /* Binary semaphore controlling access. */
+    struct list_elem elem;      /* Element in holder's held_locks. */
+    int priority;               /* Highest priority donated by waiters. */
   };
 
 void lock_init (struct lock *);
@@ -33,7 +36,7 @@ bool lock_held_by_current_thread (const struct lock *);
 /* Condition variable. */
 struct condition 
   {
-    struct list waiters;        /* List of waiting threads. */
+    struct heap waiters;        /* Waiting semaphore_elems, by priority. */
   };
 
 void cond_init (struct condition *);
@@ -41,6 +44,30 @@ void cond_wait (struct condition *, struct lock *);
 void cond_signal (struct condition *, struct lock *);
 void cond_broadcast (struct condition *, struct lock *);
 
+/* Reader-writer lock. */
+struct rwlock 
+  {
+    struct lock lock;           /* Protects the members below. */
+    struct condition readers_ok;/* Signaled when readers may enter. */
+    struct condition writers_ok;/* Signaled when a writer may enter. */
+    struct condition upgrade_ok;/* Signaled when an upgrade may finish. */
+    int readers;                /* # of threads holding it shared. */
+    struct thread *writer;      /* Thread holding it exclusive. */
+    int waiting_writers;        /* # of threads waiting for exclusive. */
+    bool upgrading;             /* A reader is waiting to upgrade? */
+  };
+
+void rwlock_init (struct rwlock *);
+void rwlock_acquire_shared (struct rwlock *);
+bool rwlock_try_acquire_shared (struct rwlock *);
+void rwlock_release_shared (struct rwlock *);
+void rwlock_acquire_exclusive (struct rwlock *);
+bool rwlock_try_acquire_exclusive (struct rwlock *);
+void rwlock_release_exclusive (struct rwlock *);
+bool rwlock_upgrade (struct rwlock *);
+void rwlock_downgrade (struct rwlock *);
+bool rwlock_held_exclusive (const struct rwlock *);
+
 /* Optimization barrier.
 
    The compiler will not reorder operations across an
@@ -20,12 +20,35 @@
    of thread.h for details. */
 #define THREAD_MAGIC 0xcd6abf4b
 
-/* List of processes in THREAD_READY state, that is, processes
-   that are ready to run but not actually running. */
-static struct list ready_list;
-
-/* List of processes in THREAD_BLOCKED state.(Alarm clock) */
-static struct list sleep_list;
+/* Processes in THREAD_READY state, that is, processes that are
+   ready to run but not actually running.  There is one FIFO
+   queue per priority level, and bit P of ready_mask is set iff
+   ready_queues[P] is non-empty, so the highest-priority ready
+   thread is found with a single find-first-set. */
+static struct list ready_queues[PRI_MAX + 1];
+static uint64_t ready_mask;
+static int ready_cnt;           /* # of threads in ready_queues. */
+
+/* Run queue of the stride scheduler, ordered by pass.  Running a
+   thread for one tick advances its pass by STRIDE1 / tickets, and
+   the thread with the lowest pass runs next, so over time each
+   thread runs in proportion to its tickets.  stride_pass is the
+   pass of the thread picked most recently; a thread entering the
+   run queue starts no earlier than that, so time spent blocked
+   does not bank CPU time. */
+#define STRIDE1 (1 << 20)
+static struct heap stride_heap;
+static int64_t stride_pass;
+
+/* Processes in THREAD_BLOCKED state.(Alarm clock)
+   A hashed timer wheel: a thread sleeping until tick T is kept
+   in slot T % SLEEP_WHEEL_SIZE, so putting a thread to sleep or
+   taking it out is O(1).  On each tick only the slot for that
+   tick is examined; threads in it whose wakeup lies one or more
+   revolutions ahead are left in place. */
+#define SLEEP_WHEEL_SIZE 256    /* Must be a power of 2. */
+static struct list sleep_wheel[SLEEP_WHEEL_SIZE];
+static int sleep_cnt;           /* # of threads in sleep_wheel. */
 
 /* List of all processes.  Processes are added to this list
    when they are first scheduled and removed when they exit. */
@@ -48,20 +71,39 @@ struct kernel_thread_frame
     void *aux;                  /* Auxiliary data for function. */
   };
 
+/* Recycled thread pages.
+   A dead thread's page is kept here instead of going back to the
+   page allocator, so that a thread_create() following a thread
+   exit needs no zeroed page.  Each cached page starts with the
+   list_elem linking it into the cache. */
+#define THREAD_CACHE_MAX 16     /* Max. # of entries in the cache. */
+static struct list page_cache;
+
 /* Statistics. */
 static long long idle_ticks;    /* # of timer ticks spent idle. */
 static long long kernel_ticks;  /* # of timer ticks in kernel threads. */
 static long long user_ticks;    /* # of timer ticks in user programs. */
+static long long page_hits;     /* # of thread pages taken from cache. */
+static long long page_misses;   /* # of thread pages from palloc. */
+static int64_t last_tick;       /* timer_ticks() at last thread_tick(). */
 
 /* Scheduling. */
 #define TIME_SLICE 4            /* # of timer ticks to give each thread. */
 static unsigned thread_ticks;   /* # of timer ticks since last yield. */
-static int64_t wakeup_tick;     /* Closest tick that some threads
-								   in sleep_list need to wake up. */
+static int64_t wheel_tick;      /* First tick whose slot in sleep_wheel
+								   has not been processed yet. */
 
 static fixpoint load_avg;       /* Stores avg. # of threads ready to run
 								   over the past minute. */
 
+/* recent_cpu decays once per second by (2*load_avg)/(2*load_avg+1).
+   decay_hist[S % DECAY_HISTORY] keeps the factor of second S, and
+   decay_epoch counts the seconds so far; recent_cpu_update()
+   applies to a thread whichever decays it has not seen yet. */
+#define DECAY_HISTORY 256       /* Must be a power of 2. */
+static fixpoint decay_hist[DECAY_HISTORY];
+static int64_t decay_epoch;
+
 #ifndef USERPROG
 bool thread_prior_aging;
 #endif
@@ -71,6 +113,11 @@ bool thread_prior_aging;
    Controlled by kernel command-line option "-o mlfqs". */
 bool thread_mlfqs;
 
+/* If false (default), use the priority scheduler or mlfqs.
+   If true, use stride scheduler.
+   Controlled by kernel command-line option "-stride". */
+bool thread_stride;
+
 static void kernel_thread (thread_func *, void *aux);
 
 static void idle (void *aux UNUSED);
@@ -82,6 +129,25 @@ static void *alloc_frame (struct thread *, size_t size);
 static void schedule (void);
 void thread_schedule_tail (struct thread *prev);
 static tid_t allocate_tid (void);
+static void ready_push (struct thread *);
+static void ready_requeue (struct thread *);
+static void ready_remove (struct thread *);
+static int ready_top_level (void);
+static int ready_best_level (void);
+static int ready_max_priority (void);
+#ifndef USERPROG
+static int thread_aged_priority (struct thread *);
+#endif
+static struct thread *thread_page_get (void);
+static void thread_page_put (struct thread *);
+static struct list *sleep_slot (int64_t tick);
+static void sleep_wakeup (int64_t now, bool preempt);
+static int64_t next_wakeup_tick (void);
+static bool stride_less (const struct heap_elem *, const struct heap_elem *,
+                         void *aux);
+static bool stride_preempt (void);
+static void stride_print_shares (void);
+static void decay_update (struct thread *, void *aux);
 
 /* Initializes the threading system by transforming the code
    that's currently running into a thread.  This can't work in
@@ -99,20 +165,29 @@ static tid_t allocate_tid (void);
 void
 thread_init (void) 
 {
+  int i;
+
   ASSERT (intr_get_level () == INTR_OFF);
 
   lock_init (&tid_lock);
-  list_init (&ready_list);
-  list_init (&sleep_list);
+  for (i = PRI_MIN; i <= PRI_MAX; i++)
+    list_init (&ready_queues[i]);
+  ready_mask = 0;
+  ready_cnt = 0;
+  heap_init (&stride_heap, stride_less, NULL);
+  stride_pass = 0;
+  for (i = 0; i < SLEEP_WHEEL_SIZE; i++)
+    list_init (&sleep_wheel[i]);
+  sleep_cnt = 0;
   list_init (&all_list);
-  /* Initialize lock for file system. */
-  lock_init(&fLock);
+  list_init (&page_cache);
 
-  /* Initialize wake up tick for alarm clock. */
-  wakeup_tick = INT64_MAX;
+  /* Initialize timer wheel position for alarm clock. */
+  wheel_tick = 0;
 
   /* Initialize load_avg for 4.4BSD Scheduler. */
   load_avg = 0;
+  decay_epoch = 0;
 
   /* Set up a thread structure for the running thread. */
   initial_thread = running_thread ();
@@ -150,7 +225,10 @@ thread_tick (void)
   struct thread *t = thread_current ();
   int64_t curr_t = timer_ticks();
 
-  /* Update statistics. */
+  /* Update statistics.  Ticks that passed without an interrupt
+	 (tickless idle) were all spent idle. */
+  idle_ticks += curr_t - last_tick - 1;
+  last_tick = curr_t;
   if (t == idle_thread)
     idle_ticks++;
 #ifdef USERPROG
@@ -159,39 +237,24 @@ thread_tick (void)
 #endif
   else
     kernel_ticks++;
+  if (t != idle_thread)
+    {
+      t->run_ticks++;
+      if (thread_stride)
+        t->pass += STRIDE1 / t->tickets;
+    }
+#ifdef USERPROG
+  process_update_info (t);
+#endif
 
   /* Enforce preemption. */
   if (++thread_ticks >= TIME_SLICE)
     intr_yield_on_return ();
 
-  /* Wake up blocked thread, if any thread need to be. */
-  if(curr_t >= wakeup_tick){
-	do{
-	  /* Get blocked thread which has lowest tick in
-		 sleep_list. */
-	  struct list_elem *e = list_front(&sleep_list);
-	  struct thread *cur = list_entry(e, struct thread, elem);
-
-	  /* Loop must be stopped when lowest tick in sleep_list
-		 if greater then current tick. */
-	  if(cur->tick > wakeup_tick) break;
-
-	  /* Remove from sleep list and add to ready queue. */
-	  list_pop_front(&sleep_list);
-      thread_unblock(cur);
-
-	  /* Loop must be stopped when list is empty. */
-	} while(!list_empty(&sleep_list));
-
-	/* Update wakeup_tick. */
-	wakeup_tick = list_empty(&sleep_list) ? INT64_MAX : 
-	  list_entry(list_front(&sleep_list), struct thread, elem)->tick;
-  }
-
-#ifndef USERPROG
-  if (thread_prior_aging == true)
-	thread_aging();
-#endif
+  /* Wake up blocked thread, if any thread need to be.  All due
+	 threads are woken here, as one batch, so that the scheduler
+	 chooses among all of them at once. */
+  sleep_wakeup(curr_t, true);
 
   if(thread_mlfqs){
 	enum intr_level old_level;
@@ -201,40 +264,110 @@ thread_tick (void)
 	   thread's recent_cpu is incremented by 1. */
     t->recent_cpu += (1 & (t != idle_thread)) * FP;
 
-	/* Every second, update every thread's recent_cpu
-	   and load_avg. */
+	/* Every second, update load_avg, record this second's
+	   recent_cpu decay, and apply it to every thread.  The decay
+	   changes every thread's priority, in either direction when
+	   nice is positive, so waiting threads must be requeued now
+	   for the choice of the next thread to stay right.  Between
+	   seconds only the running thread's recent_cpu changes, so
+	   the other ticks stay O(1) in the # of threads. */
 	if(timer_ticks() % TIMER_FREQ == 0){
 	  fixpoint upd;
 
 	  /* Update load_avg. */
 	  load_avg = 59 * load_avg + 
-		(list_size(&ready_list) + (thread_current() != idle_thread)) * FP;
+		(ready_cnt + (t != idle_thread)) * FP;
 	  load_avg = load_avg / 60;
 
 	  /* Calculate (2*load_avg)/(2*load_avg+1) part to
 		 avoid executing same operation over threads. */
 	  upd = ((int64_t)(2 * load_avg) * FP / (2 * load_avg + 1 * FP));
 
-	  /* Update thread's recent_cpu. */
-	  thread_foreach(recent_cpu_update, (void *)&upd);
+	  decay_hist[(uint32_t) decay_epoch & (DECAY_HISTORY - 1)] = upd;
+	  decay_epoch++;
+	  thread_foreach(decay_update, NULL);
 	}
 
-	/* Every four ticks, update every thread's priority. */
-	if(timer_ticks() % TIME_SLICE == 0){
-	  thread_foreach(priority_update, NULL);
-	  list_sort(&ready_list, priority_comp, NULL);
-	}
+	/* Every four ticks, update running thread's priority.
+	   Only its recent_cpu has grown since the last update. */
+	if(timer_ticks() % TIME_SLICE == 0 && t != idle_thread)
+	  priority_update(t);
 
 	intr_set_level(old_level);
   }
 }
 
+/* Applies the latest recent_cpu decay to T and recomputes its
+   priority, moving it to its new place in the run queue or wait
+   queue it is in.  For use with thread_foreach(). */
+static void
+decay_update (struct thread *t, void *aux UNUSED)
+{
+  if(t != idle_thread)
+	priority_update(t);
+}
+
 /* Prints thread statistics. */
 void
 thread_print_stats (void) 
 {
   printf ("Thread: %lld idle ticks, %lld kernel ticks, %lld user ticks\n",
           idle_ticks, kernel_ticks, user_ticks);
+  printf ("Thread: page cache %lld hits, %lld misses\n",
+          page_hits, page_misses);
+  if (thread_stride)
+    stride_print_shares ();
+}
+
+/* Prints, for each live thread, the share of CPU time it got
+   against the share its tickets entitle it to, both in tenths of
+   a percent of the time used by live threads.  The largest
+   difference is the scheduler's fairness error. */
+static void
+stride_print_shares (void)
+{
+  long long total_ticks = 0, total_tickets = 0;
+  int max_err = 0;
+  enum intr_level old_level;
+  struct list_elem *e;
+
+  old_level = intr_disable ();
+  for (e = list_begin (&all_list); e != list_end (&all_list);
+       e = list_next (e))
+    {
+      struct thread *t = list_entry (e, struct thread, allelem);
+      if (t == idle_thread)
+        continue;
+      total_ticks += t->run_ticks;
+      total_tickets += t->tickets;
+    }
+  if (total_ticks == 0)
+    {
+      intr_set_level (old_level);
+      return;
+    }
+
+  for (e = list_begin (&all_list); e != list_end (&all_list);
+       e = list_next (e))
+    {
+      struct thread *t = list_entry (e, struct thread, allelem);
+      int share, target;
+      if (t == idle_thread)
+        continue;
+      share = t->run_ticks * 1000 / total_ticks;
+      target = t->tickets * 1000 / total_tickets;
+      printf ("Thread: %s: %d tickets, %lld ticks, "
+              "share %d.%d%%, target %d.%d%%\n",
+              t->name, t->tickets, t->run_ticks,
+              share / 10, share % 10, target / 10, target % 10);
+      if (share - target > max_err)
+        max_err = share - target;
+      if (target - share > max_err)
+        max_err = target - share;
+    }
+  intr_set_level (old_level);
+  printf ("Thread: stride fairness error %d.%d%%\n",
+          max_err / 10, max_err % 10);
 }
 
 /* Creates a new kernel thread named NAME with the given initial
@@ -266,7 +399,7 @@ thread_create (const char *name, int priority,
   ASSERT (function != NULL);
 
   /* Allocate thread. */
-  t = palloc_get_page (PAL_ZERO);
+  t = thread_page_get ();
   if (t == NULL)
     return TID_ERROR;
 
@@ -296,36 +429,29 @@ thread_create (const char *name, int priority,
 
   intr_set_level (old_level);
 
-  /* Add this thread to curr thread's children list. */
-  list_push_back(&thread_current()->childList, &t->childElem);
   t->parent = thread_current();
 
-  /* Allocate file descriptor table. */
-  t->fdTable = malloc(sizeof(uint32_t) * 128);
-  if(!t->fdTable){
-	free(t->fdTable);
-	return TID_ERROR;
-  }
-
   /* Set thread's niceness and recent_cpu as parent's. */
+  old_level = intr_disable ();
+  recent_cpu_update(t->parent);
   t->nice = t->parent->nice;
   t->recent_cpu = t->parent->recent_cpu;
+  intr_set_level (old_level);
 
   /* Add to run queue. */
   thread_unblock (t);
 
   /* If current thread no longer has the highest
 	 priority, yields. */
-  if(priority_comp(list_begin(&ready_list),
-		           &thread_current()->elem, NULL))
-	thread_yield();
+  thread_preempt();
   
   return tid;
 }
 
 /* Puts current thread to sleep, with alarm clock method.
-   Sets thread's tick as given tick, and push into sleep list,
-   then call thread_block(). */
+   Sets thread's tick as given tick, and push into timer wheel,
+   then call thread_block().  Returns at once if given tick has
+   already passed. */
 void
 thread_sleep (int64_t ticks)
 {
@@ -335,21 +461,173 @@ thread_sleep (int64_t ticks)
   /* Turn off interrupts for calling thread_block(). */
   old_level = intr_disable();
 
+  /* Slot for a tick already processed would not come up again
+	 until the next revolution. */
+  if(ticks < wheel_tick){
+	intr_set_level(old_level);
+	return;
+  }
+
   cur = thread_current();
 
   /* Set tick for current thread. */
   cur->tick = ticks;
 
-  /* Update wakeup_tick if given tick is smaller than this. */
-  wakeup_tick = wakeup_tick > ticks ? ticks : wakeup_tick;
-
   /* Add to sleep queue. */
-  list_insert_ordered(&sleep_list, &cur->elem, tick_comp, NULL);
+  list_push_back(sleep_slot(ticks), &cur->elem);
+  sleep_cnt++;
   thread_block();
 
   intr_set_level(old_level);
 }
 
+/* Returns a page for a new struct thread and its kernel stack,
+   from the cache if possible, otherwise from the page allocator,
+   or a null pointer if none is available.  The page need not be
+   zeroed: init_thread() clears struct thread, and the stack is
+   built by thread_create(). */
+static struct thread *
+thread_page_get (void)
+{
+  enum intr_level old_level = intr_disable ();
+  struct thread *t = NULL;
+
+  if (!list_empty (&page_cache))
+    {
+      t = (struct thread *) list_pop_front (&page_cache);
+      page_hits++;
+    }
+  else
+    page_misses++;
+  intr_set_level (old_level);
+
+  return t != NULL ? t : palloc_get_page (0);
+}
+
+/* Gives thread page T back, to the cache if there is room.
+   Called by the scheduler, so must not sleep. */
+static void
+thread_page_put (struct thread *t)
+{
+  enum intr_level old_level = intr_disable ();
+
+  if (list_size (&page_cache) < THREAD_CACHE_MAX)
+    list_push_front (&page_cache, (struct list_elem *) t);
+  else
+    palloc_free_page (t);
+  intr_set_level (old_level);
+}
+
+/* Returns the earliest tick at which the scheduler has work to
+   do while no thread is ready: the first tick some sleeping
+   thread is due, or with the MLFQS the next once-per-second
+   update.  Looks at most one revolution of the wheel ahead.
+   Must be called with interrupts off. */
+static int64_t
+next_wakeup_tick (void)
+{
+  int64_t next = INT64_MAX;
+  int64_t tick;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  for(tick = wheel_tick; sleep_cnt > 0 && next == INT64_MAX
+	  && tick < wheel_tick + SLEEP_WHEEL_SIZE; tick++){
+	struct list *slot = sleep_slot(tick);
+	struct list_elem *e;
+
+	for(e = list_begin(slot); e != list_end(slot); e = list_next(e))
+	  if(list_entry(e, struct thread, elem)->tick <= tick){
+		next = tick;
+		break;
+	  }
+  }
+  if(sleep_cnt > 0 && next == INT64_MAX)
+	next = wheel_tick + SLEEP_WHEEL_SIZE;
+
+  if(thread_mlfqs){
+	int64_t second = (timer_ticks() / TIMER_FREQ + 1) * TIMER_FREQ;
+	next = second < next ? second : next;
+  }
+  return next;
+}
+
+/* Returns the timer wheel slot for threads waking up at TICK. */
+static struct list *
+sleep_slot (int64_t tick)
+{
+  return &sleep_wheel[(uint32_t) tick & (SLEEP_WHEEL_SIZE - 1)];
+}
+
+/* Wakes up every sleeping thread whose tick is NOW or earlier,
+   processing the slots of all ticks since the last call.  The
+   woken threads are made ready as one batch, and if PREEMPT is
+   true the running thread is preempted once, at the end, if any
+   of them has a higher priority.  Must be called with interrupts
+   off. */
+static void
+sleep_wakeup (int64_t now, bool preempt)
+{
+  int woken_pri = -1;
+  int64_t last;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if(now < wheel_tick)
+	return;
+  if(sleep_cnt == 0){
+	wheel_tick = now + 1;
+	return;
+  }
+
+  /* Every slot needs looking at only once, however many ticks
+	 were missed. */
+  last = now - wheel_tick >= SLEEP_WHEEL_SIZE ?
+	wheel_tick + SLEEP_WHEEL_SIZE - 1 : now;
+
+  for(; wheel_tick <= last && sleep_cnt > 0; wheel_tick++){
+	struct list *slot = sleep_slot(wheel_tick);
+	struct list_elem *e = list_begin(slot);
+
+	while(e != list_end(slot)){
+	  struct thread *t = list_entry(e, struct thread, elem);
+
+	  /* Due on a later revolution of the wheel. */
+	  if(t->tick > now){
+		e = list_next(e);
+		continue;
+	  }
+
+	  e = list_remove(e);
+	  sleep_cnt--;
+	  thread_unblock(t);
+	  if(t->priority > woken_pri) woken_pri = t->priority;
+	}
+  }
+  wheel_tick = now + 1;
+
+  if(preempt && (thread_stride ? stride_preempt()
+	                           : woken_pri > thread_current()->priority)){
+	if(intr_context())
+	  intr_yield_on_return();
+	else
+	  thread_yield();
+  }
+}
+
+/* Wakes every sleeping thread whose tick is NOW or earlier,
+   without yielding.  For timer_idle_exit(), which credits ticks
+   that passed with the timer stopped while the scheduler is about
+   to pick the next thread, so that the woken threads take part in
+   that choice.  Must be called with interrupts off. */
+void
+thread_wake_sleepers (int64_t now)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  sleep_wakeup(now, false);
+}
+
 /* Puts the current thread to sleep.  It will not be scheduled
    again until awoken by thread_unblock().
 
@@ -383,9 +661,11 @@ thread_unblock (struct thread *t)
 
   old_level = intr_disable ();
   ASSERT (t->status == THREAD_BLOCKED);
-  //list_push_back (&ready_list, &t->elem);
-  if(t != idle_thread)
-	list_insert_ordered(&ready_list, &t->elem, priority_comp, NULL);
+  if(t != idle_thread){
+	/* Catch up on decays missed while blocked. */
+	if(thread_mlfqs) priority_update(t);
+	ready_push(t);
+  }
   t->status = THREAD_READY;
   intr_set_level (old_level);
 }
@@ -456,8 +736,11 @@ thread_yield (void)
 
   old_level = intr_disable ();
   if (cur != idle_thread) 
-    //list_push_back (&ready_list, &cur->elem);
-	list_insert_ordered (&ready_list, &cur->elem, priority_comp, NULL);
+    {
+      if (thread_mlfqs)
+        priority_update (cur);
+      ready_push (cur);
+    }
   cur->status = THREAD_READY;
   schedule ();
   intr_set_level (old_level);
@@ -480,17 +763,44 @@ thread_foreach (thread_action_func *func, void *aux)
     }
 }
 
-/* Sets the current thread's priority to NEW_PRIORITY. */
+/* Sets the current thread's base priority to NEW_PRIORITY.
+   Its effective priority stays higher while any thread waiting
+   on a lock it holds has a higher priority. */
 void
 thread_set_priority (int new_priority) 
 {
-  thread_current ()->priority = new_priority;
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+
+  old_level = intr_disable ();
+  cur->base_priority = new_priority;
+  thread_refresh_priority (cur);
+  intr_set_level (old_level);
   
   /* If current thread no longer has the highest
 	 priority, yields. */
-  if(priority_comp(list_begin(&ready_list),
-		           &thread_current()->elem, NULL))
-	thread_yield();
+  thread_preempt();
+}
+
+/* Recomputes T's effective priority as the larger of its base
+   priority and the highest priority donated through any lock it
+   holds.  Interrupts must be off. */
+void
+thread_refresh_priority (struct thread *t)
+{
+  int priority = t->base_priority;
+  struct list_elem *e;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  for (e = list_begin (&t->held_locks); e != list_end (&t->held_locks);
+       e = list_next (e))
+    {
+      struct lock *lock = list_entry (e, struct lock, elem);
+      if (lock->priority > priority)
+        priority = lock->priority;
+    }
+  thread_set_ready_priority (t, priority);
 }
 
 /* Returns the current thread's priority. */
@@ -505,16 +815,19 @@ void
 thread_set_nice (int nice) 
 {
   struct thread *cur = thread_current();
+  enum intr_level old_level;
 
   /* Update nice, then recalculate priority. */
+  old_level = intr_disable();
   cur->nice = nice;
-  priority_update(cur, NULL);
+  priority_update(cur);
+  if(thread_stride)
+	thread_set_tickets(TICKETS_NICE(nice));
+  intr_set_level(old_level);
 
   /* If current thread no longer has the highest
 	 priority, yields. */
-  if(priority_comp(list_begin(&ready_list),
-		           &thread_current()->elem, NULL))
-	thread_yield();
+  thread_preempt();
 }
 
 /* Returns the current thread's nice value. */
@@ -524,6 +837,28 @@ thread_get_nice (void)
   return thread_current()->nice;
 }
 
+/* Returns the current thread's stride scheduler tickets. */
+int
+thread_get_tickets (void)
+{
+  return thread_current()->tickets;
+}
+
+/* Sets the current thread's stride scheduler tickets to TICKETS,
+   clamped to [TICKETS_MIN, TICKETS_MAX], and returns the old
+   value.  Takes effect from the next tick the thread runs. */
+int
+thread_set_tickets (int tickets)
+{
+  struct thread *cur = thread_current();
+  int old = cur->tickets;
+
+  if(tickets < TICKETS_MIN) tickets = TICKETS_MIN;
+  if(tickets > TICKETS_MAX) tickets = TICKETS_MAX;
+  cur->tickets = tickets;
+  return old;
+}
+
 /* Returns 100 times the system load average. */
 int
 thread_get_load_avg (void) 
@@ -537,7 +872,13 @@ thread_get_load_avg (void)
 int
 thread_get_recent_cpu (void) 
 {
-  fixpoint ret = thread_current()->recent_cpu * 100;
+  enum intr_level old_level = intr_disable();
+  fixpoint ret;
+
+  recent_cpu_update(thread_current());
+  ret = thread_current()->recent_cpu * 100;
+  intr_set_level(old_level);
+
   return ret & (1 << 31) ? ((ret - FP / 2) / FP) 
 	                       : ((ret + FP / 2) / FP);
 }
@@ -562,8 +903,13 @@ idle (void *idle_started_ UNUSED)
     {
       /* Let someone else run. */
       intr_disable ();
+      timer_idle_exit ();
       thread_block ();
 
+      /* Nothing to run: in tickless mode, have the timer stay
+         quiet until the next thread is due to wake up. */
+      timer_idle_enter (next_wakeup_tick ());
+
       /* Re-enable interrupts and wait for the next one.
 
          The `sti' instruction disables interrupts until the
@@ -576,6 +922,7 @@ idle (void *idle_started_ UNUSED)
 
          See [IA32-v2a] "HLT", [IA32-v2b] "STI", and [IA32-v3a]
          7.11.1 "HLT Instruction". */
+      intr_note_enable ();
       asm volatile ("sti; hlt" : : : "memory");
     }
 }
@@ -625,27 +972,33 @@ init_thread (struct thread *t, const char *name, int priority)
   t->status = THREAD_BLOCKED;
   strlcpy (t->name, name, sizeof t->name);
   t->stack = (uint8_t *) t + PGSIZE;
-  t->priority = priority;
+  t->priority = t->base_priority = priority;
+  list_init (&t->held_locks);
   t->magic = THREAD_MAGIC;
   list_push_back (&all_list, &t->allelem);
 
-  /* Initialize thread's child list. */
-  list_init (&t->childList);
+  /* Initialize thread's child lists. */
+  t->child_status = NULL;
+  list_init (&t->children);
+  list_init (&t->exited_children);
+  cond_init (&t->child_exited);
 
   /* Initialize thread's semaphores. */
-  sema_init(&t->wait, 0);
   sema_init(&t->load, 0);
-  sema_init(&t->exec, 0);
 
   /* Initialize thread's file. */
   t->curFile = NULL;
 
-  /* Initialize thread's fd. 
-     Since 0, 1 are reserved, it starts with 2. */
-  t->fd = 2;
+  /* File descriptor table is created on first open. */
+  t->fdtable = NULL;
+  t->ring = NULL;
 
   /* Initialize thread's niceness and recent_cpu. */
   t->nice = t->recent_cpu = 0;
+  t->decay_epoch = decay_epoch;
+
+  /* Initialize thread's stride scheduler state. */
+  t->tickets = TICKETS_NICE(0);
 }
 
 /* Allocates a SIZE-byte frame at the top of thread T's stack and
@@ -669,10 +1022,247 @@ alloc_frame (struct thread *t, size_t size)
 static struct thread *
 next_thread_to_run (void) 
 {
-  if (list_empty (&ready_list))
+  struct thread *t;
+
+  if (thread_stride)
+    {
+      if (heap_empty (&stride_heap))
+        return idle_thread;
+      t = heap_entry (heap_pop (&stride_heap), struct thread, stride_elem);
+      ready_cnt--;
+      stride_pass = t->pass;
+      return t;
+    }
+
+  if (ready_mask == 0)
     return idle_thread;
+
+  t = list_entry (list_front (&ready_queues[ready_best_level ()]),
+                  struct thread, elem);
+  ready_remove (t);
+#ifndef USERPROG
+  /* Priority gained while waiting is kept, and survives the end
+     of any donation. */
+  if (thread_prior_aging)
+    {
+      int aged = thread_aged_priority (t);
+      t->base_priority += aged - t->priority;
+      t->priority = aged;
+    }
+#endif
+  return t;
+}
+
+/* Appends T to the run queue of its priority level.
+   Interrupts must be off. */
+static void
+ready_push (struct thread *t)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (PRI_MIN <= t->priority && t->priority <= PRI_MAX);
+
+  if (thread_stride)
+    {
+      if (t->pass < stride_pass)
+        t->pass = stride_pass;
+      heap_push (&stride_heap, &t->stride_elem);
+      ready_cnt++;
+      t->ready_tick = last_tick;
+      return;
+    }
+
+  list_push_back (&ready_queues[t->priority], &t->elem);
+  ready_mask |= (uint64_t) 1 << t->priority;
+  ready_cnt++;
+  t->ready_tick = last_tick;
+}
+
+/* Puts T back in the run queue after a priority change, at the
+   tail of its new queue, in O(1).  Each queue is kept in
+   nondecreasing ready_tick order, so that its front is its longest
+   waiter: T keeps the ready_tick from when it was first queued
+   unless the new tail entered later, in which case T takes the
+   tail's, giving up only the part of its wait that would put it
+   ahead of threads it now queues behind.  Interrupts must be off. */
+static void
+ready_requeue (struct thread *t)
+{
+  int64_t ready_tick = t->ready_tick;
+  struct list *queue = &ready_queues[t->priority];
+
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (PRI_MIN <= t->priority && t->priority <= PRI_MAX);
+
+  if (!thread_stride && !list_empty (queue))
+    {
+      struct thread *tail = list_entry (list_back (queue),
+                                        struct thread, elem);
+      if (tail->ready_tick > ready_tick)
+        ready_tick = tail->ready_tick;
+    }
+  ready_push (t);
+  t->ready_tick = ready_tick;
+}
+
+/* Removes T, which must be in the run queue, from the run queue.
+   Interrupts must be off. */
+static void
+ready_remove (struct thread *t)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (thread_stride)
+    {
+      heap_remove (&stride_heap, &t->stride_elem);
+      ready_cnt--;
+      return;
+    }
+
+  list_remove (&t->elem);
+  if (list_empty (&ready_queues[t->priority]))
+    ready_mask &= ~((uint64_t) 1 << t->priority);
+  ready_cnt--;
+}
+
+/* Returns the highest non-empty run queue level, or -1 if the
+   run queue is empty.  bsr on each 32-bit half of the mask, so
+   the cost does not depend on the number of ready threads. */
+static int
+ready_top_level (void)
+{
+  uint32_t hi = ready_mask >> 32;
+  uint32_t lo = ready_mask;
+
+  if (hi != 0)
+    return 63 - __builtin_clz (hi);
+  else if (lo != 0)
+    return 31 - __builtin_clz (lo);
+  else
+    return -1;
+}
+
+/* Returns the run queue level whose front thread should run
+   next, or -1 if the run queue is empty.  With aging, each
+   queue's front thread has waited longest in it, so only the
+   fronts of the (at most 64) non-empty queues are compared. */
+static int
+ready_best_level (void)
+{
+#ifndef USERPROG
+  if (thread_prior_aging && ready_mask != 0)
+    {
+      int p, best = -1, best_pri = -1;
+
+      for (p = PRI_MAX; p >= PRI_MIN && best_pri < PRI_MAX; p--)
+        if (ready_mask & ((uint64_t) 1 << p))
+          {
+            struct thread *t = list_entry (list_front (&ready_queues[p]),
+                                           struct thread, elem);
+            int pri = thread_aged_priority (t);
+            if (pri > best_pri)
+              {
+                best = p;
+                best_pri = pri;
+              }
+          }
+      return best;
+    }
+#endif
+  return ready_top_level ();
+}
+
+/* Returns the highest priority among ready threads, or -1 if
+   the run queue is empty. */
+static int
+ready_max_priority (void)
+{
+  int p = ready_best_level ();
+
+  if (p < 0)
+    return -1;
+#ifndef USERPROG
+  if (thread_prior_aging)
+    return thread_aged_priority (list_entry (list_front (&ready_queues[p]),
+                                             struct thread, elem));
+#endif
+  return p;
+}
+
+/* Sets T's priority to PRIORITY, moving T to the matching run
+   queue if it is ready to run, and to its new place in the
+   semaphore or condition variable queue it is waiting in. */
+void
+thread_set_ready_priority (struct thread *t, int priority)
+{
+  enum intr_level old_level;
+
+  if (t->priority == priority)
+    return;
+
+  old_level = intr_disable ();
+  if (t->wait_queue != NULL)
+    heap_remove (t->wait_queue, t->wait_queue_elem);
+  if (t->status == THREAD_READY && t != idle_thread)
+    {
+      ready_remove (t);
+      t->priority = priority;
+      ready_requeue (t);
+    }
   else
-    return list_entry (list_pop_front (&ready_list), struct thread, elem);
+    t->priority = priority;
+  if (t->wait_queue != NULL)
+    heap_push (t->wait_queue, t->wait_queue_elem);
+  intr_set_level (old_level);
+}
+
+/* Yields the CPU if some ready thread has a higher priority
+   than the running thread.  In an interrupt handler, yields on
+   return from the interrupt instead. */
+void
+thread_preempt (void)
+{
+  enum intr_level old_level;
+  bool yield;
+
+  old_level = intr_disable ();
+  yield = (thread_stride ? stride_preempt ()
+           : ready_max_priority () > thread_current ()->priority);
+  intr_set_level (old_level);
+
+  if (!yield)
+    return;
+  if (intr_context ())
+    intr_yield_on_return ();
+  else
+    thread_yield ();
+}
+
+/* Orders threads by pass, then by tid so that the order of
+   threads with equal passes is deterministic. */
+static bool
+stride_less (const struct heap_elem *a_, const struct heap_elem *b_,
+             void *aux UNUSED)
+{
+  const struct thread *a = heap_entry (a_, struct thread, stride_elem);
+  const struct thread *b = heap_entry (b_, struct thread, stride_elem);
+
+  if (a->pass != b->pass)
+    return a->pass < b->pass;
+  return a->tid < b->tid;
+}
+
+/* Returns true if some ready thread is behind the running thread
+   under the stride scheduler.  Interrupts must be off. */
+static bool
+stride_preempt (void)
+{
+  struct thread *cur = thread_current ();
+
+  if (heap_empty (&stride_heap))
+    return false;
+  return (cur == idle_thread
+          || heap_entry (heap_min (&stride_heap), struct thread,
+                         stride_elem)->pass < cur->pass);
 }
 
 /* Completes a thread switch by activating the new thread's page
@@ -704,6 +1294,11 @@ thread_schedule_tail (struct thread *prev)
   /* Start new time slice. */
   thread_ticks = 0;
 
+  /* Apply the recent_cpu decays that passed while we were off the
+     CPU before any new ticks are charged to us. */
+  if (thread_mlfqs && cur != idle_thread)
+    recent_cpu_update (cur);
+
 #ifdef USERPROG
   /* Activate the new address space. */
   process_activate ();
@@ -717,7 +1312,7 @@ thread_schedule_tail (struct thread *prev)
   if (prev != NULL && prev->status == THREAD_DYING && prev != initial_thread) 
     {
       ASSERT (prev != cur);
-      palloc_free_page (prev);
+      thread_page_put (prev);
     }
 }
 
@@ -732,11 +1327,21 @@ static void
 schedule (void) 
 {
   struct thread *cur = running_thread ();
-  struct thread *next = next_thread_to_run ();
+  struct thread *next;
   struct thread *prev = NULL;
 
   ASSERT (intr_get_level () == INTR_OFF);
   ASSERT (cur->status != THREAD_RUNNING);
+
+  /* Leaving the idle thread ends any tickless period, even if an
+     interrupt handler rather than the idle loop switched us away:
+     the next thread needs the periodic tick for preemption, and
+     sleepers that came due while the timer was stopped must be
+     woken before the next thread is chosen. */
+  if (cur == idle_thread)
+    timer_idle_exit ();
+
+  next = next_thread_to_run ();
   ASSERT (is_thread (next));
 
   if (cur != next)
@@ -762,45 +1367,34 @@ allocate_tid (void)
    Used by switch.S, which can't figure it out on its own. */
 uint32_t thread_stack_ofs = offsetof (struct thread, stack);
 
-/* For using list_insert_ordered(), this func returns
-   true if a's priority is greater than b's,
-   false if a's priority is equal or less than b's. */
-bool
-priority_comp (const struct list_elem *a, 
-	                const struct list_elem *b, void *aux UNUSED)
+/* Brings thread's recent_cpu up to date, applying every
+   once-per-second decay it has missed since it was last
+   examined, in order.  Decays older than DECAY_HISTORY seconds
+   are forgotten and skipped. */
+void
+recent_cpu_update (struct thread *t)
 {
-  return list_entry(a, struct thread, elem)->priority
-	     > list_entry(b, struct thread, elem)->priority;
-}
+  int64_t s = decay_epoch - t->decay_epoch;
 
-/* For using list_insert_ordered(), this func returns
-   true if a's tick is less than b's,
-   false if a's tick is equal or greater than b's. */
-bool
-tick_comp (const struct list_elem *a, 
-	       const struct list_elem *b, void *aux UNUSED)
-{
-  return list_entry(a, struct thread, elem)->tick
-	     < list_entry(b, struct thread, elem)->tick;
-}
+  ASSERT (intr_get_level () == INTR_OFF);
 
-/* To update recent_cpu every second, calculate new
-   value and assign into thread's recent_cpu.
-   To use thread_foreach(), this func forms like this. */
-void
-recent_cpu_update (struct thread *t, void *aux)
-{
-  fixpoint upd = *(fixpoint *)aux;
-  t->recent_cpu = ((int64_t)upd * t->recent_cpu / FP) 
-	              + t->nice * FP;
+  if(s > DECAY_HISTORY) s = DECAY_HISTORY;
+
+  for(s = decay_epoch - s; s < decay_epoch; s++){
+	fixpoint upd = decay_hist[(uint32_t) s & (DECAY_HISTORY - 1)];
+	t->recent_cpu = ((int64_t)upd * t->recent_cpu / FP) 
+	                + t->nice * FP;
+  }
+  t->decay_epoch = decay_epoch;
 }
 
-/* To update priority on each four ticks, calculate new
-   value and assign into thread's recent_cpu.
-   To use thread_foreach(), this func forms like this. */
+/* To update priority, bring recent_cpu up to date, then
+   calculate new value and assign into thread's priority. */
 void
-priority_update (struct thread *t, void *aux UNUSED)
+priority_update (struct thread *t)
 {
+  recent_cpu_update(t);
+
   /* Stores current thread's recent cpu value
 	 with nearest integer value. */
   int recent_cpu_int = t->recent_cpu & (1 << 31) ?
@@ -808,21 +1402,19 @@ priority_update (struct thread *t, void *aux UNUSED)
 	: (t->recent_cpu + FP / 2) / FP;
 
   int upd = PRI_MAX - recent_cpu_int / 4 - t->nice * 2;
-  t->priority = upd > PRI_MAX ? PRI_MAX : upd < PRI_MIN ? PRI_MIN : upd;
+  thread_set_ready_priority(t, upd > PRI_MAX ? PRI_MAX
+	                           : upd < PRI_MIN ? PRI_MIN : upd);
 }
 
 #ifndef USERPROG
 /* Implements thread aging.
-   For every threads in ready_list, increase priority. */
-void
-thread_aging (void)
+   A thread gains one priority level for every tick it has spent
+   in run queue, up to PRI_MAX.  Nothing is updated per tick:
+   the aged priority is derived from the time it was queued. */
+static int
+thread_aged_priority (struct thread *t)
 {
-  struct list_elem *e;
-  for(e = list_begin(&ready_list);
-	  e != list_end(&ready_list); e = list_next(e))
-  {
-	struct thread *cur = list_entry(e, struct thread, elem);
-	if(cur->priority != PRI_MAX) cur->priority += 1;
-  }
+  int64_t aged = t->priority + (last_tick - t->ready_tick);
+  return aged > PRI_MAX ? PRI_MAX : aged;
 }
 #endif
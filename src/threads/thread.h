@@ -4,6 +4,7 @@
 #include <debug.h>
 #include <list.h>
 #include <hash.h>
+#include <heap.h>
 #include <stdint.h>
 #include "threads/synch.h"
 
@@ -30,6 +31,14 @@ typedef int tid_t;
 #define PRI_DEFAULT 31                  /* Default priority. */
 #define PRI_MAX 63                      /* Highest priority. */
 
+/* Stride scheduler tickets.  A thread's share of the CPU is its
+   tickets over the total tickets of runnable threads.  By
+   default tickets follow nice: 410 at nice -20, 210 at nice 0,
+   10 at nice 20. */
+#define TICKETS_MIN 1                   /* Fewest tickets. */
+#define TICKETS_MAX 1000                /* Most tickets. */
+#define TICKETS_NICE(NICE) ((21 - (NICE)) * 10)
+
 /* Project 1, for distinguish integer from real. */
 typedef int32_t fixpoint;
 #define FP (1 << 14)
@@ -42,9 +51,6 @@ struct fileEntry
 	struct list_elem link;
   };
 
-/* Project 2, lock for synchronization. */
-struct lock fLock;
-
 /* A kernel thread or user process.
 
    Each thread structure is stored in its own 4 kB page.  The
@@ -96,11 +102,12 @@ struct lock fLock;
    set to THREAD_MAGIC.  Stack overflow will normally change this
    value, triggering the assertion. */
 /* The `elem' member has a dual purpose.  It can be an element in
-   the run queue (thread.c), or it can be an element in a
-   semaphore wait list (synch.c).  It can be used these two ways
-   only because they are mutually exclusive: only a thread in the
-   ready state is on the run queue, whereas only a thread in the
-   blocked state is on a semaphore wait list. */
+   the run queue (thread.c), or it can be an element in the sleep
+   wheel (thread.c).  It can be used these two ways only because
+   they are mutually exclusive: only a thread in the ready state
+   is on the run queue, whereas only a thread in the blocked state
+   is in the sleep wheel.  A thread waiting on a semaphore is in
+   the semaphore's heap through `wait_elem' instead. */
 struct thread
   {
     /* Owned by thread.c. */
@@ -108,40 +115,47 @@ struct thread
     enum thread_status status;          /* Thread state. */
     char name[16];                      /* Name (for debugging purposes). */
     uint8_t *stack;                     /* Saved stack pointer. */
-    int priority;                       /* Priority. */
+    int priority;                       /* Priority, including donation. */
+    int base_priority;                  /* Priority before donation. */
     struct list_elem allelem;           /* List element for all threads list. */
 
     /* Shared between thread.c and synch.c. */
     struct list_elem elem;              /* List element. */
+    struct list held_locks;             /* Locks held, for donation. */
+    struct lock *waiting_lock;          /* Lock being waited for. */
+    struct heap_elem wait_elem;         /* Element in semaphore waiters. */
+    uint64_t wait_seq;                  /* Order of arrival in waiters. */
+    struct heap *wait_queue;            /* Wait queue to keep in priority
+                                           order, or null. */
+    struct heap_elem *wait_queue_elem;  /* Our element in wait_queue. */
 
 #ifdef USERPROG
     /* Owned by userprog/process.c. */
     uint32_t *pagedir;                  /* Page directory. */
+    struct kinfo *kinfo;                /* Info page, or null. */
 #endif
 
 	/* Added for project 1. */
-    int exit_status;                    /* Stores exit status. */
-
 	struct thread *parent;              /* Parent. */
-	
-	struct list childList;
-	struct list_elem childElem;         /* Children. */
 
-	/* up : When thread is ready for being terminated.
-	   down : Prepare for terminating itself. */
-	struct semaphore wait;
+	/* Exit status records, owned by userprog/process.c. */
+	struct child_status *child_status;  /* Our record in our parent's
+										   table, or null. */
+	struct list children;               /* Records of our children. */
+	struct list exited_children;        /* Records of exited children
+										   not yet waited for. */
+	struct condition child_exited;      /* Signaled when a child exits. */
+
 	/* up : When load operation ends.
 	   down : Wait for being loaded. */
 	struct semaphore load;
-	/* up : Good to be terminated.
-	   down : After being loaded, wait for being excuted. */
-	struct semaphore exec;              /* For synchronization. */
 
 	/* Added for project 2. */
-	int fd;                             /* Stores fd, 
-										   next file will get fd+1 for fd. */
+	struct fdtable *fdtable;            /* File descriptor table, created
+										   on first open. */
 
-	struct file **fdTable;              /* File descriptor table. */
+	struct ring *ring;                  /* Submission/completion ring in
+										   user memory, or null. */
 
 	struct file *curFile;               /* For denying write on file which
 										   this thread opens. */
@@ -149,11 +163,21 @@ struct thread
 	/* Added for project 1(Thread). */
 	int64_t tick;                       /* Stores tick,
 						   				   when thread needs to wake up. */
+	int64_t ready_tick;                 /* Tick when thread entered
+										   run queue, for aging. */
 	int nice;                           /* Stores niceness of this thread. */
 	fixpoint recent_cpu;                /* Stores amount of CPU time this
 										   thread has recieved recently. */
+	int64_t decay_epoch;                /* # of recent_cpu decays already
+										   applied to recent_cpu. */
+	int tickets;                        /* Stride scheduler tickets. */
+	int64_t pass;                       /* Stride scheduler virtual time,
+										   lowest pass runs next. */
+	struct heap_elem stride_elem;       /* Element in stride run queue. */
+	int64_t run_ticks;                  /* # of timer ticks spent running. */
 	/* Added for project 3. */
 	uint8_t *esp;						/* Store current stack pointer. */
+	int64_t page_faults;                /* # of page faults taken. */
 	struct hash supPT;				    /* Supplemental page table. */
 
     /* Owned by thread.c. */
@@ -165,6 +189,10 @@ struct thread
    Controlled by kernel command-line option "-o mlfqs". */
 extern bool thread_mlfqs;
 
+/* If true, use stride (proportional-share) scheduler.
+   Controlled by kernel command-line option "-stride". */
+extern bool thread_stride;
+
 void thread_init (void);
 void thread_start (void);
 
@@ -175,6 +203,7 @@ typedef void thread_func (void *aux);
 tid_t thread_create (const char *name, int priority, thread_func *, void *);
 
 void thread_sleep (int64_t ticks);
+void thread_wake_sleepers (int64_t now);
 void thread_block (void);
 void thread_unblock (struct thread *);
 
@@ -191,17 +220,17 @@ void thread_foreach (thread_action_func *, void *);
 
 int thread_get_priority (void);
 void thread_set_priority (int);
+void thread_set_ready_priority (struct thread *, int priority);
+void thread_refresh_priority (struct thread *);
+void thread_preempt (void);
 
 int thread_get_nice (void);
 void thread_set_nice (int);
+int thread_get_tickets (void);
+int thread_set_tickets (int);
 int thread_get_recent_cpu (void);
 int thread_get_load_avg (void);
 
-bool priority_comp (const struct list_elem *a, 
-                    const struct list_elem *b, void *aux UNUSED);
-bool tick_comp (const struct list_elem *a, 
-	           const struct list_elem *b, void *aux UNUSED);
-void recent_cpu_update (struct thread *t, void *aux);
-void priority_update (struct thread *t, void *aux UNUSED);
-void thread_aging (void);
+void recent_cpu_update (struct thread *t);
+void priority_update (struct thread *t);
 #endif /* threads/thread.h */
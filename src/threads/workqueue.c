@@ -0,0 +1,101 @@
+#include "threads/workqueue.h"
+#include <debug.h>
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/thread.h"
+
+/* A queue of work items and the thread that runs them. */
+struct workqueue
+  {
+    struct list items;          /* Pending struct work's, FIFO. */
+    struct semaphore sema;      /* Counts items; worker waits here. */
+    tid_t worker;               /* Worker thread. */
+  };
+
+static thread_func worker_thread;
+
+/* Creates a workqueue whose worker thread is named NAME and runs
+   at PRIORITY.  Returns the new workqueue, or a null pointer if
+   memory or the thread could not be allocated.  May sleep. */
+struct workqueue *
+workqueue_create (const char *name, int priority) 
+{
+  struct workqueue *wq;
+
+  ASSERT (!intr_context ());
+
+  wq = malloc (sizeof *wq);
+  if (wq == NULL)
+    return NULL;
+  list_init (&wq->items);
+  sema_init (&wq->sema, 0);
+  wq->worker = thread_create (name, priority, worker_thread, wq);
+  if (wq->worker == TID_ERROR) 
+    {
+      free (wq);
+      return NULL;
+    }
+  return wq;
+}
+
+/* Initializes W to call FUNC with AUX available in W->aux. */
+void
+work_init (struct work *w, work_func *func, void *aux) 
+{
+  ASSERT (w != NULL);
+  ASSERT (func != NULL);
+
+  w->func = func;
+  w->aux = aux;
+  w->pending = false;
+}
+
+/* Queues W to be run by WQ's worker thread.  Returns true if W
+   was queued, false if it was already pending; in that case the
+   earlier queuing still stands, and W will run once for both.
+   May be called from an interrupt handler. */
+bool
+work_queue (struct workqueue *wq, struct work *w) 
+{
+  enum intr_level old_level;
+  bool queued = false;
+
+  ASSERT (wq != NULL);
+  ASSERT (w != NULL);
+
+  old_level = intr_disable ();
+  if (!w->pending) 
+    {
+      w->pending = true;
+      list_push_back (&wq->items, &w->elem);
+      sema_up (&wq->sema);
+      queued = true;
+    }
+  intr_set_level (old_level);
+
+  return queued;
+}
+
+/* Runs the work queued on workqueue WQ_, forever.  A work item
+   is no longer pending once it starts running, so it may queue
+   itself again. */
+static void
+worker_thread (void *wq_) 
+{
+  struct workqueue *wq = wq_;
+
+  for (;;) 
+    {
+      enum intr_level old_level;
+      struct work *w;
+
+      sema_down (&wq->sema);
+
+      old_level = intr_disable ();
+      w = list_entry (list_pop_front (&wq->items), struct work, elem);
+      w->pending = false;
+      intr_set_level (old_level);
+
+      w->func (w);
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef THREADS_WORKQUEUE_H
+#define THREADS_WORKQUEUE_H
+
+#include <list.h>
+#include <stdbool.h>
+#include "threads/synch.h"
+
+/* Deferred work ("bottom halves").
+
+   An interrupt handler must not sleep and should not run long,
+   since interrupts stay off for as long as it runs.  Work that
+   does not have to happen in the handler itself can instead be
+   queued on a workqueue, whose worker thread runs it later with
+   interrupts on.  Each workqueue has one worker thread, created
+   at the priority given to workqueue_create(), so urgent and
+   bulk work can be kept on separate queues. */
+
+struct work;
+typedef void work_func (struct work *);
+
+/* A unit of deferred work.  Usually embedded in a larger
+   structure, from which FUNC recovers it with list_entry()-style
+   pointer arithmetic, or carries what it needs in AUX. */
+struct work
+  {
+    struct list_elem elem;      /* Element in workqueue's list. */
+    work_func *func;            /* Function to run. */
+    void *aux;                  /* For use by FUNC. */
+    bool pending;               /* Queued but not yet started? */
+  };
+
+struct workqueue;
+
+struct workqueue *workqueue_create (const char *name, int priority);
+void work_init (struct work *, work_func *, void *aux);
+bool work_queue (struct workqueue *, struct work *);
+
+#endif /* threads/workqueue.h */
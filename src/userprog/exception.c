@@ -2,16 +2,22 @@
 #include <inttypes.h>
 #include <stdio.h>
 #include "userprog/gdt.h"
+#include "userprog/process.h"
+#include "threads/flags.h"
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 #include "threads/palloc.h"
 #include "threads/vaddr.h"
 #include "userprog/syscall.h"
+#ifdef VM
+#include "vm/page.h"
+#endif
 
 /* Number of page faults processed. */
 static long long page_fault_cnt;
 
 static void kill (struct intr_frame *);
+static void debug (struct intr_frame *);
 static void page_fault (struct intr_frame *);
 
 /* Registers handlers for interrupts that can be caused by user
@@ -46,7 +52,7 @@ exception_init (void)
      caused indirectly, e.g. #DE can be caused by dividing by
      0.  */
   intr_register_int (0, 0, INTR_ON, kill, "#DE Divide Error");
-  intr_register_int (1, 0, INTR_ON, kill, "#DB Debug Exception");
+  intr_register_int (1, 0, INTR_OFF, debug, "#DB Debug Exception");
   intr_register_int (6, 0, INTR_ON, kill, "#UD Invalid Opcode Exception");
   intr_register_int (7, 0, INTR_ON, kill,
                      "#NM Device Not Available Exception");
@@ -111,6 +117,25 @@ kill (struct intr_frame *f)
     }
 }
 
+/* Debug exception handler.  SYSENTER does not clear the trap
+   flag, so a user program that sets it and then makes a system
+   call with SYSENTER gets a single-step trap in kernel mode, on
+   the SYSENTER stack, before sysenter_entry's first instruction.
+   Clear TF and let sysenter_entry go on.  Any other debug
+   exception is handled like the rest, by kill(). */
+static void
+debug (struct intr_frame *f) 
+{
+  if (f->cs == SEL_KCSEG && f->eip == sysenter_entry)
+    {
+      f->eflags &= ~FLAG_TF;
+      return;
+    }
+
+  intr_enable ();
+  kill (f);
+}
+
 /* Page fault handler.  This is a skeleton that must be filled in
    to implement virtual memory.  Some solutions to project 2 may
    also require modifying this code.
@@ -145,6 +170,8 @@ page_fault (struct intr_frame *f)
 
   /* Count page faults. */
   page_fault_cnt++;
+  thread_current ()->page_faults++;
+  process_update_info (thread_current ());
 
   /* Determine cause. */
   not_present = (f->error_code & PF_P) == 0;
@@ -160,6 +187,18 @@ page_fault (struct intr_frame *f)
 */
 
 #if VM
+  /* Bring in a page of the executable on first touch. */
+  if(not_present && is_user_vaddr(fault_addr)
+	 && thread_current()->pagedir != NULL){
+	struct supPTE *spte = get_supPTE(fault_addr);
+
+	if(spte){
+	  if((write && !spte->writable) || !load_page(spte))
+		goto VIOLATION;
+	  return;
+	}
+  }
+
   /* When trying to write on read-only page,
 	 or read at non-present page. */
   if(!not_present || (not_present && !write))
@@ -210,7 +249,7 @@ VIOLATION:
 #endif
 
   /* When page fault occurs in kernel. 
-     ( To use get_user in syscall.c ) */
+     ( To use get_user in usercopy.c ) */
   if(!user){
 	/* Copies eax value into eip. */
 	f->eip = (void (*)(void))f->eax;
@@ -0,0 +1,170 @@
+#include "userprog/fdtable.h"
+#include <bitmap.h>
+#include <debug.h>
+#include <stddef.h>
+#include <string.h>
+#include "filesys/file.h"
+#include "threads/malloc.h"
+
+/* A process's file descriptor table.
+
+   FILES is indexed directly by descriptor, so looking one up is
+   O(1), and USED has bit FD set for every descriptor in use, so
+   that a new descriptor is always the lowest free one.  Both
+   double in size when full, up to FD_MAX entries. */
+struct fdtable
+  {
+    struct file **files;        /* files[FD] is FD's file, or null. */
+    struct bitmap *used;        /* Bit FD set iff FD is in use. */
+    int size;                   /* Number of entries in FILES. */
+  };
+
+static bool fdtable_grow (struct fdtable *, int min_size);
+
+/* Returns a new descriptor table, with only the console
+   descriptors 0 and 1 in use, or a null pointer if memory is
+   short. */
+struct fdtable *
+fdtable_create (void) 
+{
+  struct fdtable *t = malloc (sizeof *t);
+  if (t == NULL)
+    return NULL;
+
+  t->files = calloc (FD_INIT, sizeof *t->files);
+  t->used = bitmap_create (FD_INIT);
+  t->size = FD_INIT;
+  if (t->files == NULL || t->used == NULL) 
+    {
+      free (t->files);
+      if (t->used != NULL)
+        bitmap_destroy (t->used);
+      free (t);
+      return NULL;
+    }
+  bitmap_set_multiple (t->used, 0, 2, true);
+  return t;
+}
+
+/* Closes every file open in T and frees T.  T may be null. */
+void
+fdtable_destroy (struct fdtable *t) 
+{
+  int fd;
+
+  if (t == NULL)
+    return;
+
+  for (fd = 2; fd < t->size; fd++)
+    if (t->files[fd] != NULL)
+      file_close (t->files[fd]);
+  free (t->files);
+  bitmap_destroy (t->used);
+  free (t);
+}
+
+/* Installs FILE in T under the lowest free descriptor and returns
+   that descriptor, or -1 if T is full.  T then owns FILE. */
+int
+fdtable_install (struct fdtable *t, struct file *file) 
+{
+  size_t fd;
+
+  ASSERT (file != NULL);
+
+  fd = bitmap_scan_and_flip (t->used, 0, 1, false);
+  if (fd == BITMAP_ERROR) 
+    {
+      if (!fdtable_grow (t, t->size + 1))
+        return -1;
+      fd = bitmap_scan_and_flip (t->used, 0, 1, false);
+      ASSERT (fd != BITMAP_ERROR);
+    }
+  t->files[fd] = file;
+  return fd;
+}
+
+/* Installs FILE in T under descriptor FD, first closing whatever
+   file FD referred to, and returns FD.  Returns -1 if FD is one
+   of the console descriptors or beyond FD_MAX, or if T could not
+   grow to hold it.  T then owns FILE. */
+int
+fdtable_install_at (struct fdtable *t, int fd, struct file *file) 
+{
+  ASSERT (file != NULL);
+
+  if (fd < 2 || fd >= FD_MAX)
+    return -1;
+  if (fd >= t->size && !fdtable_grow (t, fd + 1))
+    return -1;
+
+  if (t->files[fd] != NULL)
+    file_close (t->files[fd]);
+  t->files[fd] = file;
+  bitmap_mark (t->used, fd);
+  return fd;
+}
+
+/* Returns the file that descriptor FD refers to in T, or a null
+   pointer if FD is not open or is a console descriptor.  T may
+   be null, for a process that has never opened a file. */
+struct file *
+fdtable_lookup (const struct fdtable *t, int fd) 
+{
+  if (t == NULL || fd < 0 || fd >= t->size)
+    return NULL;
+  return t->files[fd];
+}
+
+/* Frees descriptor FD in T and returns the file it referred to,
+   which the caller must close, or a null pointer if FD was not
+   open. */
+struct file *
+fdtable_remove (struct fdtable *t, int fd) 
+{
+  struct file *file = fdtable_lookup (t, fd);
+
+  if (file != NULL) 
+    {
+      t->files[fd] = NULL;
+      bitmap_reset (t->used, fd);
+    }
+  return file;
+}
+
+/* Grows T to at least MIN_SIZE entries by repeated doubling.
+   Returns false if that would exceed FD_MAX or memory is
+   short, leaving T unchanged. */
+static bool
+fdtable_grow (struct fdtable *t, int min_size) 
+{
+  struct file **files;
+  struct bitmap *used;
+  int size, fd;
+
+  for (size = t->size; size < min_size; size *= 2)
+    continue;
+  if (size > FD_MAX)
+    return false;
+
+  files = calloc (size, sizeof *files);
+  used = bitmap_create (size);
+  if (files == NULL || used == NULL) 
+    {
+      free (files);
+      if (used != NULL)
+        bitmap_destroy (used);
+      return false;
+    }
+
+  memcpy (files, t->files, t->size * sizeof *files);
+  for (fd = 0; fd < t->size; fd++)
+    bitmap_set (used, fd, bitmap_test (t->used, fd));
+
+  free (t->files);
+  bitmap_destroy (t->used);
+  t->files = files;
+  t->used = used;
+  t->size = size;
+  return true;
+}
@@ -0,0 +1,22 @@
+#ifndef USERPROG_FDTABLE_H
+#define USERPROG_FDTABLE_H
+
+#include <stdbool.h>
+
+struct file;
+
+/* Largest number of file descriptors a process may have, and the
+   number a table starts out with.  Descriptors 0 and 1, the
+   console, are always reserved. */
+#define FD_MAX 1024
+#define FD_INIT 16
+
+struct fdtable *fdtable_create (void);
+void fdtable_destroy (struct fdtable *);
+
+int fdtable_install (struct fdtable *, struct file *);
+int fdtable_install_at (struct fdtable *, int fd, struct file *);
+struct file *fdtable_lookup (const struct fdtable *, int fd);
+struct file *fdtable_remove (struct fdtable *, int fd);
+
+#endif /* userprog/fdtable.h */
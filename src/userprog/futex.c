@@ -0,0 +1,218 @@
+#include "userprog/futex.h"
+#include <debug.h>
+#include <hash.h>
+#include <list.h>
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/pagedir.h"
+#include "userprog/textcache.h"
+
+/* Fast user-space mutexes.
+
+   A user program keeps its lock word in its own memory and only
+   enters the kernel when it has to sleep or wake someone up.
+   futex_sleep() puts the caller to sleep on a user address, but
+   only if the word there still holds the value the caller last
+   saw; futex_wakeup() wakes threads sleeping on an address.
+
+   Threads sleeping on the same word share a futex_queue, found
+   through a hash table keyed by the word's kernel address, that
+   is, by the frame that holds it.  Equal user addresses in
+   different processes thus do not mix, while processes that map
+   the same frame, as all processes running one executable do for
+   its read-only pages, meet in the same queue.  A queue exists
+   only while some thread is waiting on it.
+
+   A thread may sleep only if some other thread could wake it:
+   one in its own address space, or one in another process that
+   maps the same frame.  User processes have one thread each, so
+   on a private page futex_sleep() refuses at once instead of
+   blocking the caller for good. */
+
+/* Threads waiting on one user address. */
+struct futex_queue
+  {
+    struct hash_elem elem;      /* Element in futex_table. */
+    const int *kaddr;           /* Kernel address of the word. */
+    struct list waiters;        /* List of struct futex_waiter. */
+  };
+
+/* One waiting thread.  Lives on the waiter's stack. */
+struct futex_waiter
+  {
+    struct list_elem elem;      /* Element in futex_queue's waiters. */
+    struct semaphore sema;      /* Upped to wake the waiter. */
+  };
+
+static struct hash futex_table;
+static struct lock futex_lock;  /* Protects futex_table. */
+
+static unsigned futex_hash (const struct hash_elem *, void *aux);
+static bool futex_less (const struct hash_elem *, const struct hash_elem *,
+                        void *aux);
+static struct futex_queue *futex_find (const int *kaddr);
+static bool futex_wakeable (const int *kaddr);
+static const int *futex_lookup (uint32_t *pagedir, const int *uaddr);
+
+/* Initializes the futex table. */
+void
+futex_init (void) 
+{
+  hash_init (&futex_table, futex_hash, futex_less, NULL);
+  lock_init (&futex_lock);
+}
+
+/* If the word at user address UADDR equals EXPECTED, sleeps until
+   woken by futex_wakeup() on UADDR and returns 0.  Otherwise
+   returns -1 at once.  The check and going to sleep are atomic
+   with respect to futex_wakeup(), so a wakeup sent after the word
+   changes cannot be missed.  Also returns -1 if UADDR is not a
+   mapped, word-aligned user address, or if no other thread could
+   ever wake the caller. */
+int
+futex_sleep (const int *uaddr, int expected) 
+{
+  uint32_t *pd = thread_current ()->pagedir;
+  struct futex_queue *q;
+  struct futex_waiter w;
+  const int *kaddr;
+
+  lock_acquire (&futex_lock);
+  kaddr = futex_lookup (pd, uaddr);
+  if (kaddr == NULL || *kaddr != expected || !futex_wakeable (kaddr))
+    {
+      lock_release (&futex_lock);
+      return -1;
+    }
+
+  q = futex_find (kaddr);
+  if (q == NULL)
+    {
+      q = malloc (sizeof *q);
+      if (q == NULL)
+        {
+          lock_release (&futex_lock);
+          return -1;
+        }
+      q->kaddr = kaddr;
+      list_init (&q->waiters);
+      hash_insert (&futex_table, &q->elem);
+    }
+  sema_init (&w.sema, 0);
+  list_push_back (&q->waiters, &w.elem);
+  lock_release (&futex_lock);
+
+  sema_down (&w.sema);
+  return 0;
+}
+
+/* Wakes up to N threads sleeping on the word at user address
+   UADDR, oldest first, including threads of other processes that
+   map the same frame.  Returns the number woken. */
+int
+futex_wakeup (const int *uaddr, int n) 
+{
+  struct futex_queue *q = NULL;
+  const int *kaddr;
+  int woken = 0;
+
+  lock_acquire (&futex_lock);
+  kaddr = futex_lookup (thread_current ()->pagedir, uaddr);
+  if (kaddr != NULL)
+    q = futex_find (kaddr);
+  if (q != NULL)
+    {
+      while (woken < n && !list_empty (&q->waiters))
+        {
+          struct futex_waiter *w = list_entry (list_pop_front (&q->waiters),
+                                               struct futex_waiter, elem);
+          sema_up (&w->sema);
+          woken++;
+        }
+      if (list_empty (&q->waiters))
+        {
+          hash_delete (&futex_table, &q->elem);
+          free (q);
+        }
+    }
+  lock_release (&futex_lock);
+  return woken;
+}
+
+/* Returns the queue for the word at kernel address KADDR, or a
+   null pointer if no thread is waiting there.  futex_lock must be
+   held. */
+static struct futex_queue *
+futex_find (const int *kaddr) 
+{
+  struct futex_queue key;
+  struct hash_elem *e;
+
+  key.kaddr = kaddr;
+  e = hash_find (&futex_table, &key.elem);
+  return e != NULL ? hash_entry (e, struct futex_queue, elem) : NULL;
+}
+
+/* Returns the kernel address of the word at user address UADDR
+   in address space PAGEDIR, or a null pointer if UADDR is not a
+   mapped, word-aligned user address. */
+static const int *
+futex_lookup (uint32_t *pagedir, const int *uaddr) 
+{
+  if (!is_user_vaddr (uaddr) || (uintptr_t) uaddr % sizeof *uaddr != 0)
+    return NULL;
+  return pagedir_get_page (pagedir, uaddr);
+}
+
+/* Counts in *CNT_ the threads that share the running thread's
+   page directory.  For use with thread_foreach(). */
+static void
+count_pagedir (struct thread *t, void *cnt_) 
+{
+  int *cnt = cnt_;
+
+  if (t->pagedir == thread_current ()->pagedir)
+    (*cnt)++;
+}
+
+/* Returns true if a thread other than the running thread could
+   reach the word at kernel address KADDR to wake it: either the
+   word's frame is mapped by another process too, or another
+   thread shares the running thread's address space. */
+static bool
+futex_wakeable (const int *kaddr) 
+{
+  enum intr_level old_level;
+  int threads = 0;
+
+  if (textcache_ref_cnt (pg_round_down (kaddr)) > 1)
+    return true;
+
+  old_level = intr_disable ();
+  thread_foreach (count_pagedir, &threads);
+  intr_set_level (old_level);
+  return threads > 1;
+}
+
+/* Returns a hash of futex_queue E's key. */
+static unsigned
+futex_hash (const struct hash_elem *e, void *aux UNUSED) 
+{
+  const struct futex_queue *q = hash_entry (e, struct futex_queue, elem);
+
+  return hash_bytes (&q->kaddr, sizeof q->kaddr);
+}
+
+/* Orders futex_queues by key. */
+static bool
+futex_less (const struct hash_elem *a_, const struct hash_elem *b_,
+            void *aux UNUSED) 
+{
+  const struct futex_queue *a = hash_entry (a_, struct futex_queue, elem);
+  const struct futex_queue *b = hash_entry (b_, struct futex_queue, elem);
+
+  return a->kaddr < b->kaddr;
+}
@@ -5,6 +5,7 @@
 #include "threads/init.h"
 #include "threads/pte.h"
 #include "threads/palloc.h"
+#include "userprog/textcache.h"
 
 static uint32_t *active_pd (void);
 static void invalidate_pagedir (uint32_t *);
@@ -23,7 +24,8 @@ pagedir_create (void)
 }
 
 /* Destroys page directory PD, freeing all the pages it
-   references. */
+   references.  Shared text pages are only freed once no other
+   page directory references them. */
 void
 pagedir_destroy (uint32_t *pd) 
 {
@@ -40,7 +42,7 @@ pagedir_destroy (uint32_t *pd)
         uint32_t *pte;
         
         for (pte = pt; pte < pt + PGSIZE / sizeof *pte; pte++)
-          if (*pte & PTE_P) 
+          if ((*pte & PTE_P) && !textcache_put (pte_get_page (*pte)))
             palloc_free_page (pte_get_page (*pte));
         palloc_free_page (pt);
       }
@@ -156,6 +158,16 @@ pagedir_clear_page (uint32_t *pd, void *upage)
     }
 }
 
+/* Returns true if the PTE for virtual page VPAGE in PD allows
+   writing.
+   Returns false if PD contains no PTE for VPAGE. */
+bool
+pagedir_is_writable (uint32_t *pd, const void *vpage) 
+{
+  uint32_t *pte = lookup_page (pd, vpage, false);
+  return pte != NULL && (*pte & PTE_W) != 0;
+}
+
 /* Returns true if the PTE for virtual page VPAGE in PD is dirty,
    that is, if the page has been modified since the PTE was
    installed.
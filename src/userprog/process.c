@@ -1,12 +1,16 @@
 #include "userprog/process.h"
 #include <debug.h>
+#include <hash.h>
 #include <inttypes.h>
 #include <round.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <user/kinfo.h>
+#include "userprog/fdtable.h"
 #include "userprog/gdt.h"
 #include "userprog/pagedir.h"
+#include "userprog/textcache.h"
 #include "userprog/tss.h"
 #include "filesys/directory.h"
 #include "filesys/file.h"
@@ -14,15 +18,62 @@
 #include "threads/flags.h"
 #include "threads/init.h"
 #include "threads/interrupt.h"
+#include "threads/malloc.h"
 #include "threads/palloc.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"
+#include "devices/timer.h"
 #include "vm/page.h"
 
 static thread_func start_process NO_RETURN;
 static bool load (const char *cmdline, void (**eip) (void), void **esp);
 
+/* A child process's exit status, kept by its parent until the
+   parent waits for the child or exits.  The record outlives the
+   child's struct thread, so a child's page is freed as soon as it
+   exits, whether or not anyone has waited for it yet.
+
+   Records are found by tid through child_table, and through the
+   parent's children and exited_children lists.  All of them are
+   protected by child_lock. */
+struct child_status
+  {
+    struct hash_elem elem;          /* Element in child_table. */
+    struct list_elem child_elem;    /* Element in parent's children. */
+    struct list_elem exited_elem;   /* Element in parent's
+                                       exited_children, once exited. */
+    tid_t tid;                      /* Child's thread id. */
+    struct thread *parent;          /* Parent, or null if it exited. */
+    bool loaded;                    /* Did the child load successfully? */
+    bool exited;                    /* Has the child exited? */
+    int exit_status;                /* Exit status, once exited. */
+  };
+
+/* What process_execute() passes to start_process(). */
+struct exec_info
+  {
+    char *cmd_line;                 /* Command line, in a page. */
+    struct child_status *status;    /* Child's exit status record. */
+  };
+
+static struct hash child_table;
+static struct lock child_lock;
+
+static unsigned child_hash (const struct hash_elem *, void *aux);
+static bool child_less (const struct hash_elem *, const struct hash_elem *,
+                        void *aux);
+static struct child_status *child_find (tid_t);
+static void child_free (struct child_status *);
+
+/* Initializes the table of child exit status records. */
+void
+process_init (void) 
+{
+  hash_init (&child_table, child_hash, child_less, NULL);
+  lock_init (&child_lock);
+}
+
 /* Starts a new thread running a user program loaded from
    FILENAME.  The new thread may be scheduled (and may even exit)
    before process_execute() returns.  Returns the new process's
@@ -30,8 +81,11 @@ static bool load (const char *cmdline, void (**eip) (void), void **esp);
 tid_t
 process_execute (const char *file_name) 
 {
+  struct thread *cur = thread_current ();
+  struct exec_info info;
+  struct child_status *cs;
   char *fn_copy, *svptr, *fname;
-  tid_t tid, childtid;
+  tid_t tid;
 
   /* Make a copy of FILE_NAME.
      Otherwise there's a race between the caller and load(). */
@@ -41,32 +95,58 @@ process_execute (const char *file_name)
   strlcpy (fn_copy, file_name, PGSIZE);
 
   fname = palloc_get_page(0);
-  if(fname == NULL)
+  if(fname == NULL){
+	palloc_free_page (fn_copy);
 	return TID_ERROR;
+  }
   strlcpy (fname, file_name, PGSIZE);
 
   fname = strtok_r (fname, " ", &svptr);
 
+  /* Make the child's exit status record. */
+  cs = malloc (sizeof *cs);
+  if(cs == NULL){
+	palloc_free_page (fname);
+	palloc_free_page (fn_copy);
+	return TID_ERROR;
+  }
+  cs->tid = TID_ERROR;
+  cs->parent = cur;
+  cs->loaded = cs->exited = false;
+  cs->exit_status = -1;
+  lock_acquire (&child_lock);
+  list_push_back (&cur->children, &cs->child_elem);
+  lock_release (&child_lock);
+
   /* Create a new thread to execute FILE_NAME. */
-  tid = thread_create (fname, PRI_DEFAULT, start_process, fn_copy);
+  info.cmd_line = fn_copy;
+  info.status = cs;
+  tid = thread_create (fname, PRI_DEFAULT, start_process, &info);
 
   palloc_free_page (fname);
 
-  /* Wait for child thread being loaded. */
-  sema_down(&thread_current()->load);
+  if (tid == TID_ERROR){
+	palloc_free_page (fn_copy); 
+	lock_acquire (&child_lock);
+	list_remove (&cs->child_elem);
+	lock_release (&child_lock);
+	free (cs);
+	return TID_ERROR;
+  }
 
-  /* When laod failed. */
-  if (tid == TID_ERROR)
-    palloc_free_page (fn_copy); 
+  lock_acquire (&child_lock);
+  cs->tid = tid;
+  hash_insert (&child_table, &cs->elem);
+  lock_release (&child_lock);
 
-  /* Get thread id. */
-  childtid = list_entry(
-	  list_rbegin(&thread_current()->childList),
-	  struct thread, childElem
-	  )->tid;
+  /* Wait for child thread being loaded. */
+  sema_down(&cur->load);
 
-  if (childtid != tid)
-	tid = TID_ERROR;
+  /* When load failed, the child is already exiting.  Reap it. */
+  if (!cs->loaded){
+	process_wait (tid);
+	return TID_ERROR;
+  }
 
   return tid;
 }
@@ -74,14 +154,19 @@ process_execute (const char *file_name)
 /* A thread function that loads a user process and starts it
    running. */
 static void
-start_process (void *file_name_)
+start_process (void *info_)
 {
-  char *file_name = file_name_;
+  struct exec_info *info = info_;
+  char *file_name = info->cmd_line;
   struct intr_frame if_;
   bool success;
 
+  thread_current ()->child_status = info->status;
+
+#ifdef VM
   /* Initialize supplemental page table. */
-  // init_supPT(&thread_current()->supPT);
+  init_supPT(&thread_current()->supPT);
+#endif
 
   /* Initialize interrupt frame and load executable. */
   memset (&if_, 0, sizeof if_);
@@ -91,18 +176,15 @@ start_process (void *file_name_)
   
   success = load (file_name, &if_.eip, &if_.esp);
 
-  /* Load operation ends, no matter what load() returns. */
+  /* Load operation ends, no matter what load() returns.
+	 INFO is gone once the parent wakes up. */
+  info->status->loaded = success;
   sema_up(&thread_current()->parent->load);
 
   /* If load failed, quit. */
   palloc_free_page (file_name);
-  if (!success){
-	list_remove(&thread_current()->childElem);
+  if (!success)
     thread_exit ();
-  }
-
-  /* Good to be executed. */
-  sema_down(&thread_current()->exec);
 
   /* Start the user process by simulating a return from an
      interrupt, implemented by intr_exit (in
@@ -121,25 +203,74 @@ start_process (void *file_name_)
    been successfully called for the given TID, returns -1
    immediately, without waiting.
 
-   This function will be implemented in problem 2-2.  For now, it
-   does nothing. */
+   Built on process_waitpid(). */
 int
 process_wait (tid_t child_tid) 
+{
+  int status;
+
+  if(child_tid == TID_ERROR
+	 || process_waitpid(child_tid, &status, false) != child_tid)
+	return -1;
+  return status;
+}
+
+/* Waits for child TID to exit, or for any child if TID is -1,
+   and reaps it: stores its exit status in *STATUS, frees its
+   record, and returns its tid.  If NOHANG is true and no such
+   child has exited yet, returns 0 at once instead of waiting.
+   Returns -1 if TID is not a child of the calling process that
+   has not been waited for, or, for TID -1, if there are no such
+   children at all. */
+tid_t
+process_waitpid (tid_t tid, int *status, bool nohang) 
 {
   struct thread *cur = thread_current();
-  struct thread *t;
-  struct list_elem *e;
+  struct child_status *cs;
+
+  lock_acquire(&child_lock);
+  if(tid == -1){
+	if(list_empty(&cur->children)) goto fail;
+	while(list_empty(&cur->exited_children)){
+	  if(nohang) goto not_yet;
+	  cond_wait(&cur->child_exited, &child_lock);
+	}
+	cs = list_entry(list_front(&cur->exited_children),
+					struct child_status, exited_elem);
+  }
+  else{
+	cs = child_find(tid);
+	if(cs == NULL || cs->parent != cur) goto fail;
+	while(!cs->exited){
+	  if(nohang) goto not_yet;
+	  cond_wait(&cur->child_exited, &child_lock);
+	}
+  }
 
-  for(e = list_begin(&cur->childList); e != list_end(&cur->childList)
-	  && ((t = list_entry(e, struct thread, childElem))->tid) != child_tid; 
-	  e = list_next(e));
+  tid = cs->tid;
+  *status = cs->exit_status;
+  child_free(cs);
+  lock_release(&child_lock);
+  return tid;
+
+ not_yet:
+  lock_release(&child_lock);
+  return 0;
 
-  if(e == list_end(&cur->childList)) return -1;
+ fail:
+  lock_release(&child_lock);
+  return -1;
+}
 
-  sema_up(&t->exec);
-  sema_down(&cur->wait);
+/* Sets the current process's exit status, as reported to its
+   parent.  Processes that exit without calling this, because the
+   kernel killed them, report -1. */
+void
+process_set_exit_status (int status) 
+{
+  struct child_status *cs = thread_current()->child_status;
 
-  return cur->exit_status;
+  if(cs != NULL) cs->exit_status = status;
 }
 
 /* Free the current process's resources. */
@@ -149,6 +280,11 @@ process_exit (void)
   struct thread *cur = thread_current ();
   uint32_t *pd;
 
+  /* Close any files a process killed without syscall_exit()
+     left open. */
+  fdtable_destroy (cur->fdtable);
+  cur->fdtable = NULL;
+
   /* Destroy the current process's page directory and switch back
      to the kernel-only page directory. */
   pd = cur->pagedir;
@@ -162,9 +298,93 @@ process_exit (void)
          directory, or our active page directory will be one
          that's been freed (and cleared). */
       cur->pagedir = NULL;
+      cur->kinfo = NULL;
       pagedir_activate (NULL);
       pagedir_destroy (pd);
+#ifdef VM
+      destroy_supPT (&cur->supPT);
+#endif
     }
+
+  lock_acquire (&child_lock);
+
+  /* Tell our parent we have exited, or clean up after ourselves
+     if it already exited. */
+  if (cur->child_status != NULL)
+    {
+      struct child_status *cs = cur->child_status;
+
+      cs->exited = true;
+      if (cs->parent != NULL)
+        {
+          list_push_back (&cs->parent->exited_children, &cs->exited_elem);
+          cond_signal (&cs->parent->child_exited, &child_lock);
+        }
+      else
+        {
+          hash_delete (&child_table, &cs->elem);
+          free (cs);
+        }
+      cur->child_status = NULL;
+    }
+
+  /* Nobody will wait for our children now.  Free the records of
+     those that have exited and orphan the rest. */
+  while (!list_empty (&cur->children))
+    {
+      struct child_status *cs = list_entry (list_front (&cur->children),
+                                            struct child_status, child_elem);
+      if (cs->exited)
+        child_free (cs);
+      else
+        {
+          list_remove (&cs->child_elem);
+          cs->parent = NULL;
+        }
+    }
+
+  lock_release (&child_lock);
+}
+
+/* Removes exited child record CS from all tables and frees it.
+   child_lock must be held. */
+static void
+child_free (struct child_status *cs) 
+{
+  ASSERT (cs->exited);
+  list_remove (&cs->child_elem);
+  list_remove (&cs->exited_elem);
+  hash_delete (&child_table, &cs->elem);
+  free (cs);
+}
+
+/* Returns the record for child TID, or a null pointer if there is
+   none.  child_lock must be held. */
+static struct child_status *
+child_find (tid_t tid) 
+{
+  struct child_status key;
+  struct hash_elem *e;
+
+  key.tid = tid;
+  e = hash_find (&child_table, &key.elem);
+  return e != NULL ? hash_entry (e, struct child_status, elem) : NULL;
+}
+
+/* Hashes a child_status by tid. */
+static unsigned
+child_hash (const struct hash_elem *e, void *aux UNUSED) 
+{
+  return hash_int (hash_entry (e, struct child_status, elem)->tid);
+}
+
+/* Orders child_statuses by tid. */
+static bool
+child_less (const struct hash_elem *a, const struct hash_elem *b,
+            void *aux UNUSED) 
+{
+  return (hash_entry (a, struct child_status, elem)->tid
+          < hash_entry (b, struct child_status, elem)->tid);
 }
 
 /* Sets up the CPU for running user code in the current
@@ -181,6 +401,34 @@ process_activate (void)
   /* Set thread's kernel stack for use in processing
      interrupts. */
   tss_update ();
+
+  /* Bring the info page up to date, since the timer interrupt
+     only updates the running process's page. */
+  process_update_info (t);
+}
+
+/* Brings T's info page, if it has one, up to date.  May be
+   called from an interrupt handler.  The seq count is odd while
+   the page is inconsistent, for kinfo_read() in user space. */
+void
+process_update_info (struct thread *t) 
+{
+  struct kinfo *k = t->kinfo;
+  enum intr_level old_level;
+
+  if (k == NULL)
+    return;
+
+  old_level = intr_disable ();
+  k->seq++;
+  barrier ();
+  k->ticks = timer_ticks ();
+  k->tsc_hz = timer_tsc_hz ();
+  k->run_ticks = t->run_ticks;
+  k->page_faults = t->page_faults;
+  barrier ();
+  k->seq++;
+  intr_set_level (old_level);
 }
 
 /* We load ELF binaries.  The following definitions are taken
@@ -247,6 +495,7 @@ struct Elf32_Phdr
 #define PF_R 4          /* Readable. */
 
 static bool setup_stack (void **esp);
+static bool setup_info_page (void);
 static bool validate_segment (const struct Elf32_Phdr *, struct file *);
 static bool load_segment (struct file *file, off_t ofs, uint8_t *upage,
                           uint32_t read_bytes, uint32_t zero_bytes,
@@ -295,9 +544,7 @@ load (const char *file_name, void (**eip) (void), void **esp)
   for(str = fn_copy; (args[++argc] = strtok_r(str, " ", &svptr)); str = NULL);
 
   /* Open executable file. */
-  lock_acquire(&fLock);
   file = filesys_open (*args);
-  lock_release(&fLock);
   if (file == NULL) 
     {
       printf ("load: %s: open failed\n", file_name);
@@ -380,6 +627,10 @@ load (const char *file_name, void (**eip) (void), void **esp)
   if (!setup_stack (esp))
     goto done;
 
+  /* Map the kernel info page. */
+  if (!setup_info_page ())
+    goto done;
+
   /* Contruct ESP here. */
   /* Put arguments in stack.
      After put words in stack, substitute element as addr. of word */
@@ -461,6 +712,16 @@ validate_segment (const struct Elf32_Phdr *phdr, struct file *file)
   if (phdr->p_vaddr + phdr->p_memsz < phdr->p_vaddr)
     return false;
 
+  /* The region cannot cover the kernel info page, which
+     setup_info_page() maps at KINFO_ADDR in every process. */
+  if ((phdr->p_vaddr & ~PGMASK) < (Elf32_Addr) KINFO_ADDR + PGSIZE
+      && phdr->p_vaddr + phdr->p_memsz > (Elf32_Addr) KINFO_ADDR)
+    {
+      printf ("load: segment at %#"PE32Ax" overlaps the kernel info page\n",
+              phdr->p_vaddr);
+      return false;
+    }
+
   /* Disallow mapping page 0.
      Not only is it a bad idea to map page 0, but if we allowed
      it then user code that passed a null pointer to system calls
@@ -484,6 +745,12 @@ validate_segment (const struct Elf32_Phdr *phdr, struct file *file)
 
    The pages initialized by this function must be writable by the
    user process if WRITABLE is true, read-only otherwise.
+   Read-only pages come from the shared text cache, so processes
+   running the same executable share one copy of them.
+
+   With VM, nothing is read here: each page is only recorded in
+   the supplemental page table, and the page fault handler loads
+   it when it is first touched.
 
    Return true if successful, false if a memory allocation error
    or disk read error occurs. */
@@ -495,7 +762,6 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
   ASSERT (pg_ofs (upage) == 0);
   ASSERT (ofs % PGSIZE == 0);
 
-  file_seek (file, ofs);
   while (read_bytes > 0 || zero_bytes > 0) 
     {
       /* Calculate how to fill this page.
@@ -503,30 +769,54 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
          and zero the final PAGE_ZERO_BYTES bytes. */
       size_t page_read_bytes = read_bytes < PGSIZE ? read_bytes : PGSIZE;
       size_t page_zero_bytes = PGSIZE - page_read_bytes;
-
-      /* Get a page of memory. */
-      uint8_t *knpage = palloc_get_page (PAL_USER);
-      if (knpage == NULL)
+#ifdef VM
+      /* Load this page on first touch. */
+      if (!add_supPTE (file, ofs, upage, page_read_bytes, writable))
         return false;
+#else
+      uint8_t *knpage;
 
-      /* Load this page. */
-      if (file_read (file, knpage, page_read_bytes) != (int) page_read_bytes)
+      if (!writable)
         {
-          palloc_free_page (knpage);
-          return false; 
+          /* Map the shared copy of this page. */
+          knpage = textcache_get (file, ofs, page_read_bytes);
+          if (knpage == NULL)
+            return false;
+          if (!install_page (upage, knpage, false))
+            {
+              textcache_put (knpage);
+              return false;
+            }
         }
-      memset (knpage + page_read_bytes, 0, page_zero_bytes);
-
-      /* Add the page to the process's address space. */
-      if (!install_page (upage, knpage, writable)) 
+      else
         {
-          palloc_free_page (knpage);
-          return false; 
+          /* Get a page of memory. */
+          knpage = palloc_get_page (PAL_USER);
+          if (knpage == NULL)
+            return false;
+
+          /* Load this page. */
+          if (file_read_at (file, knpage, page_read_bytes, ofs)
+              != (int) page_read_bytes)
+            {
+              palloc_free_page (knpage);
+              return false; 
+            }
+          memset (knpage + page_read_bytes, 0, page_zero_bytes);
+
+          /* Add the page to the process's address space. */
+          if (!install_page (upage, knpage, writable)) 
+            {
+              palloc_free_page (knpage);
+              return false; 
+            }
         }
+#endif
 
       /* Advance. */
       read_bytes -= page_read_bytes;
       zero_bytes -= page_zero_bytes;
+      ofs += PGSIZE;
       upage += PGSIZE;
     }
   return true;
@@ -552,6 +842,28 @@ setup_stack (void **esp)
   return success;
 }
 
+/* Maps a page at KINFO_ADDR that the process may read but not
+   write, for process_update_info() to keep up to date.
+   validate_segment() has made sure no segment is there. */
+static bool
+setup_info_page (void) 
+{
+  struct thread *t = thread_current ();
+  uint8_t *kpage;
+
+  kpage = palloc_get_page (PAL_USER | PAL_ZERO);
+  if (kpage == NULL)
+    return false;
+  if (!install_page ((void *) KINFO_ADDR, kpage, false))
+    {
+      palloc_free_page (kpage);
+      return false;
+    }
+  t->kinfo = (struct kinfo *) kpage;
+  process_update_info (t);
+  return true;
+}
+
 /* Adds a mapping from user virtual address UPAGE to kernel
    virtual address KPAGE to the page table.
    If WRITABLE is true, the user process may modify the page;
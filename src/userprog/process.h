@@ -3,9 +3,13 @@
 
 #include "threads/thread.h"
 
+void process_init (void);
 tid_t process_execute (const char *file_name);
 int process_wait (tid_t);
+tid_t process_waitpid (tid_t, int *status, bool nohang);
+void process_set_exit_status (int status);
 void process_exit (void);
 void process_activate (void);
+void process_update_info (struct thread *);
 
 #endif /* userprog/process.h */
@@ -1,14 +1,21 @@
 #include "userprog/process.h"
 #include "userprog/syscall.h"
+#include "userprog/fdtable.h"
+#include "userprog/futex.h"
+#include "userprog/usercopy.h"
+#include <limits.h>
 #include <stdio.h>
 #include <syscall-nr.h>
+#include <user/ring.h>
 #include <user/syscall.h>
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 #include "threads/init.h"
 #include "threads/malloc.h"
+#include "threads/palloc.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
+#include "filesys/directory.h"
 #include "filesys/filesys.h"
 #include "filesys/file.h"
 
@@ -19,10 +26,13 @@ void syscall_halt (void);
 void syscall_exit (int status);
 pid_t syscall_exec (const char *cmd_line);
 int syscall_wait (pid_t pid);
+pid_t syscall_waitpid (pid_t pid, int *status, int options);
 int syscall_fib (int n);
 int syscall_sumFour (int a, int b, int c, int d);
-bool isVargs (struct intr_frame *f, int n);
-uint32_t readWord (const void *ptr);
+int syscall_tickets (int tickets);
+int syscall_futex_wait (int *addr, int expected);
+int syscall_futex_wake (int *addr, int n);
+static bool get_filename (char name[NAME_MAX + 2], const char *file);
 
 /* Project 2. */
 bool syscall_create (const char *file, unsigned initial_size);
@@ -34,43 +44,92 @@ int syscall_write (int fd, const void *buffer, unsigned size);
 void syscall_seek (int fd, unsigned position);
 unsigned syscall_tell (int fd);
 void syscall_close (int fd);
+int syscall_dup (int oldfd);
+int syscall_dup2 (int oldfd, int newfd);
+int syscall_pread (int fd, void *buffer, unsigned size, unsigned offset);
+int syscall_pwrite (int fd, const void *buffer, unsigned size,
+					unsigned offset);
+int syscall_readv (int fd, const struct iovec *iov, int iovcnt);
+int syscall_writev (int fd, const struct iovec *iov, int iovcnt);
+bool syscall_ring_setup (struct ring *ring);
+int syscall_ring_enter (unsigned to_submit);
+static int open_name (const char *name);
+static int close_fd (int fd);
+static int read_fd (int fd, void *buffer, unsigned size);
+static int write_fd (int fd, const void *buffer, unsigned size);
+static int pread_fd (int fd, void *buffer, unsigned size, unsigned offset);
+static int pwrite_fd (int fd, const void *buffer, unsigned size,
+					  unsigned offset);
+static int ring_do_sqe (const struct ring_sqe *sqe);
+static bool offset_ok (unsigned size, unsigned offset);
+static bool iovec_len_ok (const struct iovec *iov, int iovcnt);
+static bool get_iovec (struct iovec iov[IOV_MAX], const struct iovec *uiov,
+					   int iovcnt, bool write);
+static struct fdtable *get_fdtable (void);
+
+/* Number of arguments taken by each system call, which
+   syscall_handler() fetches from the user stack all at once.
+   System calls not implemented here take none. */
+#define SYSCALL_ARGS_MAX 4
+static const uint8_t syscall_argc[] =
+  {
+	[SYS_HALT] = 0,
+	[SYS_EXIT] = 1,
+	[SYS_EXEC] = 1,
+	[SYS_WAIT] = 1,
+	[SYS_CREATE] = 2,
+	[SYS_REMOVE] = 1,
+	[SYS_OPEN] = 1,
+	[SYS_FILESIZE] = 1,
+	[SYS_READ] = 3,
+	[SYS_WRITE] = 3,
+	[SYS_SEEK] = 2,
+	[SYS_TELL] = 1,
+	[SYS_CLOSE] = 1,
+	[SYS_FIB] = 1,
+	[SYS_SUMFOUR] = 4,
+	[SYS_TICKETS] = 1,
+	[SYS_FUTEX_WAIT] = 2,
+	[SYS_FUTEX_WAKE] = 2,
+	[SYS_DUP] = 1,
+	[SYS_DUP2] = 2,
+	[SYS_PREAD] = 4,
+	[SYS_PWRITE] = 4,
+	[SYS_READV] = 3,
+	[SYS_WRITEV] = 3,
+	[SYS_RING_SETUP] = 1,
+	[SYS_RING_ENTER] = 1,
+	[SYS_WAITPID] = 3,
+  };
 
-/* Reads a byte at user virtual address UADDR.
-   UADDR must be below PHYS_BASE.
-   Returns the byte value if successful, -1 if a segfault
-   occurred. */
-static int
-get_user (const uint8_t *uaddr)
-{
-  int result;
-  asm ("movl $1f, %0; movzbl %1, %0; 1:"
-       : "=&a" (result) : "m" (*uaddr));
-  return result;
-}
- 
-/* Writes BYTE to user address UDST.
-   UDST must be below PHYS_BASE.
-   Returns true if successful, false if a segfault occurred. */
-static bool
-put_user (uint8_t *udst, uint8_t byte)
+void
+syscall_init (void) 
 {
-  int error_code;
-  asm ("movl $1f, %0; movb %b2, %1; 1:"
-       : "=&a" (error_code), "=m" (*udst) : "q" (byte));
-  return error_code != -1;
+  intr_register_int (0x30, 3, INTR_ON, syscall_handler, "syscall");
+  futex_init ();
 }
 
+/* Handles a system call made with SYSENTER.  F was built by
+   sysenter_entry to look just like the frame of an `int $0x30'
+   system call. */
 void
-syscall_init (void) 
+sysenter_handler (struct intr_frame *f) 
 {
-  intr_register_int (0x30, 3, INTR_ON, syscall_handler, "syscall");
+  syscall_handler (f);
 }
 
 static void
-syscall_handler (struct intr_frame *f UNUSED) 
+syscall_handler (struct intr_frame *f) 
 {
-  /* Get system call number. */ 
-  int sysnum = (int)readWord((const void *)f->esp);
+  const uint32_t *usp = f->esp;
+  uint32_t sysnum, arg[SYSCALL_ARGS_MAX];
+
+  /* Get system call number, then all of its arguments with a
+	 single copy. */
+  if(!copy_from_user(&sysnum, usp, sizeof sysnum)
+	 || sysnum >= sizeof syscall_argc / sizeof *syscall_argc
+	 || !copy_from_user(arg, usp + 1, syscall_argc[sysnum] * sizeof *arg))
+	syscall_exit(-1);
 
   /* Save esp into thread on initial transition
 	 from user to kernel. (pintos document 4.3.3) */
@@ -84,85 +143,161 @@ syscall_handler (struct intr_frame *f UNUSED)
 	  break;
 
 	case SYS_EXIT:
-	  syscall_exit((int)readWord((const void *)(f->esp + 4)));
+	  syscall_exit((int)arg[0]);
 	  break;
 
 	case SYS_EXEC:
-	  f->eax = syscall_exec((char *)readWord((const void *)(f->esp + 4)));
+	  f->eax = syscall_exec((char *)arg[0]);
 	  break;
 
 	case SYS_WAIT:
-	  f->eax = syscall_wait((pid_t)readWord((const void *)(f->esp + 4)));
+	  f->eax = syscall_wait((pid_t)arg[0]);
+	  break;
+
+	case SYS_WAITPID:
+	  f->eax = syscall_waitpid(
+		  (pid_t)arg[0],
+		  (int *)arg[1],
+		  (int)arg[2]
+		  );
 	  break;
 
 	case SYS_FIB:
-	  f->eax = syscall_fib((int)readWord((const void *)(f->esp + 4)));
+	  f->eax = syscall_fib((int)arg[0]);
 	  break;
 
 	case SYS_SUMFOUR:
 	  f->eax = syscall_sumFour(
-		  (int)readWord((const void *)(f->esp + 4)),
-		  (int)readWord((const void *)(f->esp + 8)),
-		  (int)readWord((const void *)(f->esp + 12)), 
-		  (int)readWord((const void *)(f->esp + 16))
+		  (int)arg[0],
+		  (int)arg[1],
+		  (int)arg[2], 
+		  (int)arg[3]
+		  );
+	  break;
+
+	case SYS_TICKETS:
+	  f->eax = syscall_tickets((int)arg[0]);
+	  break;
+
+	case SYS_FUTEX_WAIT:
+	  f->eax = syscall_futex_wait(
+		  (int *)arg[0],
+		  (int)arg[1]
+		  );
+	  break;
+
+	case SYS_FUTEX_WAKE:
+	  f->eax = syscall_futex_wake(
+		  (int *)arg[0],
+		  (int)arg[1]
 		  );
 	  break;
 
 	case SYS_READ:
       f->eax = syscall_read(
-		  (int)readWord((const void *)(f->esp + 4)),
-		  (void *)readWord((const void *)(f->esp + 8)),
-		  (unsigned)readWord((const void *)(f->esp + 12))
+		  (int)arg[0],
+		  (void *)arg[1],
+		  (unsigned)arg[2]
 		  );
 	  break;
 	
 	case SYS_WRITE:
       f->eax = syscall_write(
-		  (int)readWord((const void *)(f->esp + 4)),
-		  (const void *)readWord((const void *)(f->esp + 8)),
-		  (unsigned)readWord((const void *)(f->esp + 12))
+		  (int)arg[0],
+		  (const void *)arg[1],
+		  (unsigned)arg[2]
 		  );
 	  break;
 
 	/* Project 2. */
 	case SYS_CREATE:
 	  f->eax = syscall_create(
-		  (char *)readWord((const void *)(f->esp + 4)),
-		  (unsigned)readWord((const void *)(f->esp + 8))
+		  (char *)arg[0],
+		  (unsigned)arg[1]
 		  );
 	  break;
 
 	case SYS_REMOVE:
-	  f->eax = syscall_remove((char *)readWord((const void*)(f->esp + 4)));
+	  f->eax = syscall_remove((char *)arg[0]);
 	  break;
 
 	case SYS_OPEN:
 	  f->eax = syscall_open(
-		  (char *)readWord((const void*)(f->esp + 4))
+		  (char *)arg[0]
 		  );
 	  break;
 
 	case SYS_FILESIZE:
 	  f->eax = syscall_filesize(
-		  (int)readWord((const void *)(f->esp + 4))
+		  (int)arg[0]
 		  );
 	  break;
 
 	case SYS_SEEK:
 	  syscall_seek(
-		  (int)readWord((const void *)(f->esp + 4)),
-		  (unsigned)readWord((const void *)(f->esp + 8))
+		  (int)arg[0],
+		  (unsigned)arg[1]
 		  );
 	  break;
 
 	case SYS_TELL:
 	  f->eax = syscall_tell(
-		  (int)readWord((const void *)(f->esp + 4))
+		  (int)arg[0]
 		  );
 	  break;
 
 	case SYS_CLOSE:
-	  syscall_close((int)readWord((const void *)(f->esp + 4)));
+	  syscall_close((int)arg[0]);
+	  break;
+
+	case SYS_DUP:
+	  f->eax = syscall_dup((int)arg[0]);
+	  break;
+
+	case SYS_DUP2:
+	  f->eax = syscall_dup2((int)arg[0], (int)arg[1]);
+	  break;
+
+	case SYS_PREAD:
+	  f->eax = syscall_pread(
+		  (int)arg[0],
+		  (void *)arg[1],
+		  (unsigned)arg[2],
+		  (unsigned)arg[3]
+		  );
+	  break;
+
+	case SYS_PWRITE:
+	  f->eax = syscall_pwrite(
+		  (int)arg[0],
+		  (const void *)arg[1],
+		  (unsigned)arg[2],
+		  (unsigned)arg[3]
+		  );
+	  break;
+
+	case SYS_READV:
+	  f->eax = syscall_readv(
+		  (int)arg[0],
+		  (const struct iovec *)arg[1],
+		  (int)arg[2]
+		  );
+	  break;
+
+	case SYS_WRITEV:
+	  f->eax = syscall_writev(
+		  (int)arg[0],
+		  (const struct iovec *)arg[1],
+		  (int)arg[2]
+		  );
+	  break;
+
+	case SYS_RING_SETUP:
+	  f->eax = syscall_ring_setup((struct ring *)arg[0]);
+	  break;
+
+	case SYS_RING_ENTER:
+	  f->eax = syscall_ring_enter((unsigned)arg[0]);
 	  break;
 
 	/* When given sysnum is not valid. */
@@ -182,38 +317,48 @@ void
 syscall_exit (int status)
 {
   struct thread *cur = thread_current();
-  struct thread *parent = cur->parent;
-  struct list_elem *e;
 
-  parent->exit_status = status;
+  /* Leave the exit status for our parent, which learns of it
+	 through process_exit(). */
+  process_set_exit_status(status);
 
   /* Print the process's name and exit code. */
   printf("%s: exit(%d)\n", cur->name, status);
 
-  /* Find current thread in parent's child list,
-	 and remove itself. */
-  for(e = list_begin(&parent->childList); e != list_end(&parent->childList) 
-	  && (list_entry(e, struct thread, childElem)->tid) != cur->tid;
-	  e = list_next(e));
-  list_remove(e);
-
-  /* Clean up file descriptor table, and deallocates it. */
-  while(--cur->fd > 1) file_close(cur->fdTable[cur->fd]);
-  free(cur->fdTable);
+  /* Clean up file descriptor table. */
+  fdtable_destroy(cur->fdtable);
+  cur->fdtable = NULL;
 
   file_close (cur->curFile);
 
-  /* Ready for being terminated. */
-  sema_up(&parent->wait);
-
   thread_exit();
 }
 
 pid_t
 syscall_exec (const char *cmd_line)
 {
-  readWord((const void *)cmd_line);
-  return (pid_t) process_execute (cmd_line);
+  char *kcmd_line;
+  int len;
+  pid_t pid;
+
+  kcmd_line = palloc_get_page(0);
+  if(kcmd_line == NULL) return PID_ERROR;
+
+  /* Check for bad-ptr, and for command lines too long for
+	 process_execute() to copy. */
+  len = strncpy_from_user(kcmd_line, cmd_line, PGSIZE);
+  if(len == -1){
+	palloc_free_page(kcmd_line);
+	syscall_exit(-1);
+  }
+  if(len == PGSIZE){
+	palloc_free_page(kcmd_line);
+	return PID_ERROR;
+  }
+
+  pid = (pid_t) process_execute (kcmd_line);
+  palloc_free_page(kcmd_line);
+  return pid;
 }
 
 int
@@ -222,6 +367,26 @@ syscall_wait (pid_t pid)
   return process_wait ((tid_t) pid);
 }
 
+/* Waits for child PID, or any child if PID is -1, and stores its
+   exit status in *STATUS unless STATUS is null.  With WNOHANG in
+   OPTIONS, returns 0 instead of waiting if no such child has
+   exited yet.  Returns the pid reaped, or -1 if there is no such
+   child to wait for. */
+pid_t
+syscall_waitpid (pid_t pid, int *status, int options)
+{
+  int kstatus;
+
+  /* Check STATUS first, so a reaped status cannot be lost. */
+  if(status != NULL && !user_access_ok(status, sizeof *status, true))
+	syscall_exit(-1);
+
+  pid = (pid_t) process_waitpid((tid_t) pid, &kstatus,
+								(options & WNOHANG) != 0);
+  if(pid > 0 && status != NULL) *status = kstatus;
+  return pid;
+}
+
 int
 syscall_fib (int n)
 {
@@ -236,100 +401,137 @@ syscall_sumFour (int a, int b, int c, int d)
   return a + b + c + d;
 }
 
-/* Read one word (4byte) from given ptr.
-   Checks that ptr is below PHYS_BASE,
-   and read a word using get_user.
-   If given ptr is not on below PHYS_BASE or 
-   segfalut occured while reading word, call syscall_exit(-1). */
-uint32_t
-readWord (const void *ptr)
+/* Sets stride scheduler tickets, returns the old tickets. */
+int
+syscall_tickets (int tickets)
 {
-  int i, t, ret = 0;
-  if(!is_user_vaddr(ptr)) syscall_exit(-1);
-  for(i = 0; i < 4; i++){
-	if((t = get_user((const uint8_t *)(ptr + i))) == -1) syscall_exit(-1);
-	ret |= (t << (8 * i));
-  }
-  return ret;
+  return thread_set_tickets (tickets);
+}
+
+/* Sleeps until woken by futex_wake on ADDR, if *ADDR is still
+   EXPECTED.  Returns 0 after sleeping, -1 if *ADDR differed or
+   no other thread could wake the caller. */
+int
+syscall_futex_wait (int *addr, int expected)
+{
+  /* Check for bad-ptr. */
+  if(!user_access_ok(addr, sizeof *addr, false)) syscall_exit(-1);
+  return futex_sleep(addr, expected);
+}
+
+/* Wakes up to N threads sleeping on ADDR, returns # woken. */
+int
+syscall_futex_wake (int *addr, int n)
+{
+  return futex_wakeup(addr, n);
+}
+
+/* Copies the name of a file, FILE, from user memory into NAME.
+   Calls syscall_exit(-1) if FILE is a bad pointer.  Returns
+   false if the name is too long to be the name of any file. */
+static bool
+get_filename (char name[NAME_MAX + 2], const char *file)
+{
+  int len = strncpy_from_user(name, file, NAME_MAX + 2);
+  if(len == -1) syscall_exit(-1);
+  return len <= NAME_MAX;
 }
 
 /* Project 2. */
 bool
 syscall_create (const char *file, unsigned initial_size)
 {
+  char name[NAME_MAX + 2];
+
   /* Check for bad-ptr. */
-  readWord((const void *)file);
-  return filesys_create(file, initial_size);
+  if(!get_filename(name, file)) return false;
+  return filesys_create(name, initial_size);
 }
 
 bool
 syscall_remove (const char *file)
 {
+  char name[NAME_MAX + 2];
+
   /* Check for bad-ptr. */
-  readWord((const void *)file);
-  // if(!*file) syscall_exit(-1);
-  return filesys_remove(file);
+  if(!get_filename(name, file)) return false;
+  return filesys_remove(name);
 }
 
 int
 syscall_open (const char *file)
 {
+  char name[NAME_MAX + 2];
+
   /* Check for bad-ptr. */
-  readWord((const void *)file);
+  if(!get_filename(name, file)) return -1;
+
+  return open_name(name);
+}
 
-  struct thread *cur;
+/* Opens the file called NAME, a kernel string, and returns a new
+   file descriptor for it, or -1 on failure. */
+static int
+open_name (const char *name)
+{
+  struct fdtable *fdtable;
+  int fd;
 
   /* Open file with given name. */
-  lock_acquire(&fLock);
-  struct file *f = filesys_open(file);
-  lock_release(&fLock);
+  struct file *f = filesys_open(name);
 
   /* When such file doesn't exist. */
   if( !f ) return -1;
 
-  /* Write on file descriptor table and returns that fd.
-	 (postfix for fd to store file descriptor for next file) */
-  cur = thread_current();
-  cur->fdTable[cur->fd] = f;
-  return cur->fd++;
+  /* Write on file descriptor table, in the lowest free fd,
+	 and returns that fd. */
+  fdtable = get_fdtable();
+  fd = fdtable != NULL ? fdtable_install(fdtable, f) : -1;
+  if(fd == -1) file_close(f);
+  return fd;
 }
 
 int
 syscall_filesize (int fd)
 {
-  struct thread *cur = thread_current();
+  struct file *file = fdtable_lookup(thread_current()->fdtable, fd);
   /* Check for bad file descriptor. */
-  if(fd < 2 || cur->fd <= fd) syscall_exit(-1);
+  if(file == NULL) syscall_exit(-1);
 
-  return file_length(cur->fdTable[fd]);
+  return file_length(file);
 }
 
 int
 syscall_read (int fd, void *buffer, unsigned size)
 {
-  /* Check for bad-ptr. */
-  readWord(buffer);
-  
+  /* Check for bad-ptr, over the whole buffer. */
+  if(!user_access_ok(buffer, size, true)) syscall_exit(-1);
+
+  return read_fd(fd, buffer, size);
+}
+
+/* Reads SIZE bytes from FD into BUFFER, which the caller has
+   already checked is writable user memory. */
+static int
+read_fd (int fd, void *buffer, unsigned size)
+{
   /* For project 1, stdin. */
   if(fd == 0){
+	uint8_t *dst = buffer;
 	int cnt = 0;
 	uint8_t c;
-	while(cnt < size && (c = input_getc()) != '\n'){
-	  /* If segfault occurs, call syscall_exit(). */
-	  if(!put_user((const uint8_t *)(buffer + cnt++), c)) syscall_exit(-1);
-	}
+	while(cnt < size && (c = input_getc()) != '\n')
+	  dst[cnt++] = c;
 	return cnt;
   } 
   /* For project 2, read from files. */
   else{
 	int cnt;
-	struct thread *cur = thread_current();
+	struct file *file = fdtable_lookup(thread_current()->fdtable, fd);
 	/* Check for bad file descriptor. */
-	if(fd < 2 || cur->fd <= fd || !(cur->fdTable[fd])) return -1;
+	if(file == NULL) return -1;
 
-	lock_acquire(&fLock);
-	cnt = (int)file_read(cur->fdTable[fd], buffer, size);
-	lock_release(&fLock);
+	cnt = (int)file_read(file, buffer, size);
 	return cnt;
   }
 }
@@ -337,9 +539,17 @@ syscall_read (int fd, void *buffer, unsigned size)
 int
 syscall_write (int fd, const void *buffer, unsigned size)
 {
-  /* Check for bad-ptr. */
-  readWord(buffer);
-  
+  /* Check for bad-ptr, over the whole buffer. */
+  if(!user_access_ok(buffer, size, false)) syscall_exit(-1);
+
+  return write_fd(fd, buffer, size);
+}
+
+/* Writes SIZE bytes from BUFFER to FD, which the caller has
+   already checked is readable user memory. */
+static int
+write_fd (int fd, const void *buffer, unsigned size)
+{
   /* For project 1, stdout. */
   if(fd == 1){
     putbuf((const char *)buffer, (size_t)size);
@@ -348,13 +558,11 @@ syscall_write (int fd, const void *buffer, unsigned size)
   /* For project 2, write to files. */
   else{
 	int cnt;
-	struct thread *cur = thread_current();
+	struct file *file = fdtable_lookup(thread_current()->fdtable, fd);
 	/* Check for bad file descriptor. */
-	if(fd < 2 || cur->fd <= fd || !(cur->fdTable[fd])) return -1;
+	if(file == NULL) return -1;
 
-	lock_acquire(&fLock);
-	cnt = (int)file_write(cur->fdTable[fd], buffer, size);
-	lock_release(&fLock);
+	cnt = (int)file_write(file, buffer, size);
 	return cnt;
   }
 }
@@ -362,30 +570,317 @@ syscall_write (int fd, const void *buffer, unsigned size)
 void
 syscall_seek (int fd, unsigned position)
 {
-  struct thread *cur = thread_current();
+  struct file *file = fdtable_lookup(thread_current()->fdtable, fd);
   /* Check for bad file descriptor. */
-  if(fd < 2 || cur->fd <= fd) return;
+  if(file == NULL) return;
 
-  file_seek(cur->fdTable[fd], position);
+  file_seek(file, position);
 }
 
 unsigned
 syscall_tell (int fd)
 {
-  struct thread *cur = thread_current();
+  struct file *file = fdtable_lookup(thread_current()->fdtable, fd);
   /* Check for bad file descriptor. */
-  if(fd < 2 || cur->fd <= fd) return -1;
+  if(file == NULL) return -1;
 
-  return (unsigned)file_tell(cur->fdTable[fd]);
+  return (unsigned)file_tell(file);
 }
 
 void
 syscall_close (int fd)
 {
-  struct thread *cur = thread_current();
   /* Check for bad file descriptor. */
-  if(fd < 2 || cur->fd <= fd) syscall_exit(-1);
+  if(close_fd(fd) == -1) syscall_exit(-1);
+}
+
+/* Closes FD.  Returns 0 if successful, -1 if FD is not an open
+   file. */
+static int
+close_fd (int fd)
+{
+  struct file *file = fdtable_remove(thread_current()->fdtable, fd);
+  if(file == NULL) return -1;
+
+  file_close(file);
+  return 0;
+}
+
+/* Returns a new file descriptor, the lowest free one, for the
+   file OLDFD refers to.  Both share one file position.  Returns
+   -1 if OLDFD is not an open file. */
+int
+syscall_dup (int oldfd)
+{
+  struct fdtable *fdtable = thread_current()->fdtable;
+  struct file *file = fdtable_lookup(fdtable, oldfd);
+  int fd;
+
+  /* Check for bad file descriptor. */
+  if(file == NULL) return -1;
+
+  fd = fdtable_install(fdtable, file_dup(file));
+  if(fd == -1) file_close(file);
+  return fd;
+}
+
+/* Makes NEWFD refer to the file OLDFD refers to, closing NEWFD
+   first if it was open.  Returns NEWFD, or -1 if OLDFD is not an
+   open file or NEWFD is not a valid file descriptor. */
+int
+syscall_dup2 (int oldfd, int newfd)
+{
+  struct fdtable *fdtable = thread_current()->fdtable;
+  struct file *file = fdtable_lookup(fdtable, oldfd);
+  int fd;
+
+  /* Check for bad file descriptor. */
+  if(file == NULL) return -1;
+  if(oldfd == newfd) return newfd;
+
+  fd = fdtable_install_at(fdtable, newfd, file_dup(file));
+  if(fd == -1) file_close(file);
+  return fd;
+}
+
+/* Reads SIZE bytes from FD into BUFFER, starting at byte OFFSET
+   in the file rather than at its current position, which is left
+   unchanged.  Returns the number of bytes read, or -1 if FD is
+   not an open file or the range does not fit in an off_t. */
+int
+syscall_pread (int fd, void *buffer, unsigned size, unsigned offset)
+{
+  /* Check for bad-ptr, over the whole buffer. */
+  if(!user_access_ok(buffer, size, true)) syscall_exit(-1);
+
+  return pread_fd(fd, buffer, size, offset);
+}
+
+/* Reads SIZE bytes at OFFSET in FD into BUFFER, which the caller
+   has already checked is writable user memory. */
+static int
+pread_fd (int fd, void *buffer, unsigned size, unsigned offset)
+{
+  /* Check for bad file descriptor. */
+  struct file *file = fdtable_lookup(thread_current()->fdtable, fd);
+  if(file == NULL || !offset_ok(size, offset)) return -1;
+
+  return (int)file_read_at(file, buffer, size, offset);
+}
+
+/* Writes SIZE bytes from BUFFER to FD, starting at byte OFFSET in
+   the file rather than at its current position, which is left
+   unchanged.  Returns the number of bytes written, or -1 if FD is
+   not an open file or the range does not fit in an off_t. */
+int
+syscall_pwrite (int fd, const void *buffer, unsigned size, unsigned offset)
+{
+  /* Check for bad-ptr, over the whole buffer. */
+  if(!user_access_ok(buffer, size, false)) syscall_exit(-1);
+
+  return pwrite_fd(fd, buffer, size, offset);
+}
+
+/* Writes SIZE bytes from BUFFER at OFFSET in FD, which the caller
+   has already checked is readable user memory. */
+static int
+pwrite_fd (int fd, const void *buffer, unsigned size, unsigned offset)
+{
+  /* Check for bad file descriptor. */
+  struct file *file = fdtable_lookup(thread_current()->fdtable, fd);
+  if(file == NULL || !offset_ok(size, offset)) return -1;
+
+  return (int)file_write_at(file, buffer, size, offset);
+}
+
+/* Returns true if the SIZE bytes at OFFSET all lie below INT_MAX.
+   The file layer takes offsets as a signed off_t, and a negative
+   one would reach sectors outside the file. */
+static bool
+offset_ok (unsigned size, unsigned offset)
+{
+  return offset <= INT_MAX && size <= INT_MAX - offset;
+}
+
+/* Reads from FD into each of the IOVCNT buffers in IOV in turn,
+   stopping early at end of file.  Returns the total number of
+   bytes read, or -1 if FD is not an open file, IOVCNT is not
+   between 0 and IOV_MAX, or the buffers add up to more than
+   INT_MAX bytes. */
+int
+syscall_readv (int fd, const struct iovec *iov, int iovcnt)
+{
+  struct iovec kiov[IOV_MAX];
+  int i, cnt, total = 0;
+
+  if(iovcnt < 0 || iovcnt > IOV_MAX) return -1;
+  if(!get_iovec(kiov, iov, iovcnt, true)) syscall_exit(-1);
+  if(!iovec_len_ok(kiov, iovcnt)) return -1;
+
+  for(i = 0; i < iovcnt; i++){
+	cnt = read_fd(fd, kiov[i].iov_base, kiov[i].iov_len);
+	if(cnt < 0) return -1;
+	total += cnt;
+	if((size_t)cnt < kiov[i].iov_len) break;
+  }
+  return total;
+}
+
+/* Writes each of the IOVCNT buffers in IOV to FD in turn,
+   stopping early if a write comes up short.  Returns the total number of
+   bytes written, or -1 if FD is not an open file, IOVCNT is not
+   between 0 and IOV_MAX, or the buffers add up to more than
+   INT_MAX bytes. */
+int
+syscall_writev (int fd, const struct iovec *iov, int iovcnt)
+{
+  struct iovec kiov[IOV_MAX];
+  int i, cnt, total = 0;
+
+  if(iovcnt < 0 || iovcnt > IOV_MAX) return -1;
+  if(!get_iovec(kiov, iov, iovcnt, false)) syscall_exit(-1);
+  if(!iovec_len_ok(kiov, iovcnt)) return -1;
+
+  for(i = 0; i < iovcnt; i++){
+	cnt = write_fd(fd, kiov[i].iov_base, kiov[i].iov_len);
+	if(cnt < 0) return -1;
+	total += cnt;
+	if((size_t)cnt < kiov[i].iov_len) break;
+  }
+  return total;
+}
+
+/* Copies the IOVCNT-element iovec array UIOV from user memory
+   into IOV and checks every buffer it names, for writing if
+   WRITE is true.  This is the only check readv() and writev()
+   make, so the buffers are not revalidated one by one as they
+   are used.  IOVCNT must be between 0 and IOV_MAX.  Returns false
+   if any of the memory is bad. */
+static bool
+get_iovec (struct iovec iov[IOV_MAX], const struct iovec *uiov, int iovcnt,
+		   bool write)
+{
+  int i;
+
+  ASSERT(iovcnt >= 0 && iovcnt <= IOV_MAX);
+
+  if(!copy_from_user(iov, uiov, iovcnt * sizeof *iov))
+	return false;
+
+  for(i = 0; i < iovcnt; i++)
+	if(!user_access_ok(iov[i].iov_base, iov[i].iov_len, write))
+	  return false;
+  return true;
+}
+
+/* Returns true if the IOVCNT buffer lengths in IOV add up to no
+   more than INT_MAX, so that the total fits readv()'s and
+   writev()'s return value. */
+static bool
+iovec_len_ok (const struct iovec *iov, int iovcnt)
+{
+  size_t total = 0;
+  int i;
+
+  for(i = 0; i < iovcnt; i++){
+	if(iov[i].iov_len > (size_t)INT_MAX - total) return false;
+	total += iov[i].iov_len;
+  }
+  return true;
+}
+
+/* Makes RING, a page-aligned page of user memory laid out as
+   struct ring, the current process's submission/completion ring,
+   replacing any earlier one.  Returns false if RING is not such a
+   page. */
+bool
+syscall_ring_setup (struct ring *ring)
+{
+  if(pg_ofs(ring) != 0 || !user_access_ok(ring, sizeof *ring, true))
+	return false;
+  thread_current()->ring = ring;
+  return true;
+}
+
+/* Carries out, in order, up to TO_SUBMIT of the SQEs pending in
+   the current process's ring, and posts a CQE for each.  Stops
+   early if the completion queue fills up.  Returns the number of
+   SQEs consumed, or -1 if the process has no ring. */
+int
+syscall_ring_enter (unsigned to_submit)
+{
+  struct ring *ring = thread_current()->ring;
+  unsigned done = 0;
+
+  /* The ring is user memory, so check it is still mapped. */
+  if(ring == NULL || !user_access_ok(ring, sizeof *ring, true)) return -1;
+
+  while(done < to_submit && ring->sq_head != ring->sq_tail
+		&& ring->cq_tail - ring->cq_head < RING_ENTRIES){
+	/* Copy the SQE first: the operation may overwrite the ring. */
+	struct ring_sqe sqe = ring->sqes[ring->sq_head % RING_ENTRIES];
+	struct ring_cqe cqe;
+
+	ring->sq_head++;
+	cqe.user_data = sqe.user_data;
+	cqe.res = ring_do_sqe(&sqe);
+	ring->cqes[ring->cq_tail % RING_ENTRIES] = cqe;
+	ring->cq_tail++;
+	done++;
+  }
+  return done;
+}
+
+/* Carries out SQE and returns its result.  Unlike the system
+   calls themselves, a bad user pointer only fails the one
+   operation. */
+static int
+ring_do_sqe (const struct ring_sqe *sqe)
+{
+  void *buf = (void *)sqe->buf;
+  char name[NAME_MAX + 2];
+  int len;
+
+  switch(sqe->op){
+	case RING_OP_NOP:
+	  return 0;
+
+	case RING_OP_READ:
+	  if(!user_access_ok(buf, sqe->len, true)) return -1;
+	  return read_fd(sqe->fd, buf, sqe->len);
+
+	case RING_OP_WRITE:
+	  if(!user_access_ok(buf, sqe->len, false)) return -1;
+	  return write_fd(sqe->fd, buf, sqe->len);
+
+	case RING_OP_PREAD:
+	  if(!user_access_ok(buf, sqe->len, true)) return -1;
+	  return pread_fd(sqe->fd, buf, sqe->len, sqe->offset);
+
+	case RING_OP_PWRITE:
+	  if(!user_access_ok(buf, sqe->len, false)) return -1;
+	  return pwrite_fd(sqe->fd, buf, sqe->len, sqe->offset);
+
+	case RING_OP_OPEN:
+	  len = strncpy_from_user(name, buf, sizeof name);
+	  if(len == -1 || len > NAME_MAX) return -1;
+	  return open_name(name);
+
+	case RING_OP_CLOSE:
+	  return close_fd(sqe->fd);
+
+	default:
+	  return -1;
+  }
+}
+
+/* Returns the current process's file descriptor table, creating
+   it on first use, or a null pointer if memory is short. */
+static struct fdtable *
+get_fdtable (void)
+{
+  struct thread *cur = thread_current();
 
-  file_close(cur->fdTable[fd]);
-  cur->fdTable[fd] = NULL;
+  if(cur->fdtable == NULL) cur->fdtable = fdtable_create();
+  return cur->fdtable;
 }
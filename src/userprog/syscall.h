@@ -1,6 +1,12 @@
 #ifndef USERPROG_SYSCALL_H
 #define USERPROG_SYSCALL_H
 
+struct intr_frame;
+
 void syscall_init (void);
+void sysenter_handler (struct intr_frame *);
+
+/* Fast system call entry point, in userprog/sysenter.S. */
+void sysenter_entry (void);
 
 #endif /* userprog/syscall.h */
@@ -0,0 +1,216 @@
+#include "userprog/textcache.h"
+#include <debug.h>
+#include <hash.h>
+#include <string.h>
+#include "filesys/file.h"
+#include "filesys/inode.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+
+/* Shared frames for read-only executable pages.
+
+   Every process running the same executable maps the same frame
+   for each page of its read-only segments, instead of reading a
+   private copy from disk.  Frames are found by (inode, file
+   offset, bytes read) when a segment is loaded and by kernel
+   address when a page directory is destroyed, and are reference
+   counted: a frame is freed when the last page directory mapping
+   it goes away.
+
+   Each frame keeps its inode open and denies writes to it, so
+   the contents cannot change and the inode cannot be reused for
+   another file while the frame is shared. */
+
+/* One shared frame. */
+struct text_frame
+  {
+    struct hash_elem file_elem; /* Element in frames_by_file. */
+    struct hash_elem kpage_elem; /* Element in frames_by_kpage. */
+    struct inode *inode;        /* Executable the page came from. */
+    off_t ofs;                  /* Offset of the page in INODE. */
+    size_t read_bytes;          /* Bytes read from INODE, rest zero. */
+    void *kpage;                /* The frame. */
+    int ref_cnt;                /* Number of page directories mapping it. */
+  };
+
+static struct hash frames_by_file;
+static struct hash frames_by_kpage;
+static struct lock textcache_lock; /* Protects both tables. */
+
+static unsigned file_hash (const struct hash_elem *, void *aux);
+static bool file_less (const struct hash_elem *, const struct hash_elem *,
+                       void *aux);
+static unsigned kpage_hash (const struct hash_elem *, void *aux);
+static bool kpage_less (const struct hash_elem *, const struct hash_elem *,
+                        void *aux);
+
+/* Initializes the shared text frame cache. */
+void
+textcache_init (void) 
+{
+  hash_init (&frames_by_file, file_hash, file_less, NULL);
+  hash_init (&frames_by_kpage, kpage_hash, kpage_less, NULL);
+  lock_init (&textcache_lock);
+}
+
+/* Returns a frame holding the page at offset OFS in FILE, with
+   READ_BYTES bytes read from FILE and the rest zeroed, to be
+   mapped read-only.  Shares the frame already cached for the same
+   page if there is one, otherwise reads a new one.  Each
+   successful call must be matched by a call to textcache_put().
+   Returns a null pointer if memory is short or FILE cannot be
+   read. */
+void *
+textcache_get (struct file *file, off_t ofs, size_t read_bytes) 
+{
+  struct text_frame key, *f;
+  struct hash_elem *e;
+
+  ASSERT (ofs % PGSIZE == 0);
+  ASSERT (read_bytes <= PGSIZE);
+
+  key.inode = file_get_inode (file);
+  key.ofs = ofs;
+  key.read_bytes = read_bytes;
+
+  /* Pages are read with textcache_lock held, so that two
+     processes loading the same executable at once do not both
+     read it. */
+  lock_acquire (&textcache_lock);
+  e = hash_find (&frames_by_file, &key.file_elem);
+  if (e != NULL)
+    {
+      f = hash_entry (e, struct text_frame, file_elem);
+      f->ref_cnt++;
+      lock_release (&textcache_lock);
+      return f->kpage;
+    }
+
+  f = malloc (sizeof *f);
+  if (f == NULL)
+    goto fail;
+  f->kpage = palloc_get_page (PAL_USER);
+  if (f->kpage == NULL)
+    goto fail;
+  if (file_read_at (file, f->kpage, read_bytes, ofs) != (off_t) read_bytes)
+    {
+      palloc_free_page (f->kpage);
+      goto fail;
+    }
+  memset ((uint8_t *) f->kpage + read_bytes, 0, PGSIZE - read_bytes);
+
+  f->inode = inode_reopen (key.inode);
+  inode_deny_write (f->inode);
+  f->ofs = ofs;
+  f->read_bytes = read_bytes;
+  f->ref_cnt = 1;
+  hash_insert (&frames_by_file, &f->file_elem);
+  hash_insert (&frames_by_kpage, &f->kpage_elem);
+  lock_release (&textcache_lock);
+  return f->kpage;
+
+ fail:
+  lock_release (&textcache_lock);
+  free (f);
+  return NULL;
+}
+
+/* Drops one reference to KPAGE, freeing it once unreferenced.
+   Returns true if KPAGE came from textcache_get(), false if it is
+   some other page, which the caller must free itself. */
+bool
+textcache_put (void *kpage) 
+{
+  struct text_frame key, *f;
+  struct hash_elem *e;
+
+  key.kpage = kpage;
+  lock_acquire (&textcache_lock);
+  e = hash_find (&frames_by_kpage, &key.kpage_elem);
+  if (e == NULL)
+    {
+      lock_release (&textcache_lock);
+      return false;
+    }
+
+  f = hash_entry (e, struct text_frame, kpage_elem);
+  if (--f->ref_cnt > 0)
+    {
+      lock_release (&textcache_lock);
+      return true;
+    }
+  hash_delete (&frames_by_file, &f->file_elem);
+  hash_delete (&frames_by_kpage, &f->kpage_elem);
+  lock_release (&textcache_lock);
+
+  palloc_free_page (f->kpage);
+  inode_allow_write (f->inode);
+  inode_close (f->inode);
+  free (f);
+  return true;
+}
+
+/* Returns the number of page directories mapping KPAGE if it
+   came from textcache_get(), otherwise 0. */
+int
+textcache_ref_cnt (void *kpage) 
+{
+  struct text_frame key;
+  struct hash_elem *e;
+  int ref_cnt = 0;
+
+  key.kpage = kpage;
+  lock_acquire (&textcache_lock);
+  e = hash_find (&frames_by_kpage, &key.kpage_elem);
+  if (e != NULL)
+    ref_cnt = hash_entry (e, struct text_frame, kpage_elem)->ref_cnt;
+  lock_release (&textcache_lock);
+  return ref_cnt;
+}
+
+/* Hashes a text_frame by inode, offset and bytes read.  Pages of
+   overlapping segments can share an offset but differ in how
+   much of the file they contain, so all three identify a frame. */
+static unsigned
+file_hash (const struct hash_elem *e, void *aux UNUSED) 
+{
+  const struct text_frame *f = hash_entry (e, struct text_frame, file_elem);
+  return (hash_bytes (&f->inode, sizeof f->inode) ^ hash_int (f->ofs)
+          ^ hash_int (f->read_bytes));
+}
+
+/* Orders text_frames by inode, then offset, then bytes read. */
+static bool
+file_less (const struct hash_elem *a_, const struct hash_elem *b_,
+           void *aux UNUSED) 
+{
+  const struct text_frame *a = hash_entry (a_, struct text_frame, file_elem);
+  const struct text_frame *b = hash_entry (b_, struct text_frame, file_elem);
+
+  if (a->inode != b->inode)
+    return a->inode < b->inode;
+  if (a->ofs != b->ofs)
+    return a->ofs < b->ofs;
+  return a->read_bytes < b->read_bytes;
+}
+
+/* Hashes a text_frame by kernel address. */
+static unsigned
+kpage_hash (const struct hash_elem *e, void *aux UNUSED) 
+{
+  const struct text_frame *f = hash_entry (e, struct text_frame, kpage_elem);
+  return hash_bytes (&f->kpage, sizeof f->kpage);
+}
+
+/* Orders text_frames by kernel address. */
+static bool
+kpage_less (const struct hash_elem *a_, const struct hash_elem *b_,
+            void *aux UNUSED) 
+{
+  const struct text_frame *a = hash_entry (a_, struct text_frame, kpage_elem);
+  const struct text_frame *b = hash_entry (b_, struct text_frame, kpage_elem);
+
+  return a->kpage < b->kpage;
+}
@@ -0,0 +1,15 @@
+#ifndef USERPROG_TEXTCACHE_H
+#define USERPROG_TEXTCACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "filesys/off_t.h"
+
+struct file;
+
+void textcache_init (void);
+void *textcache_get (struct file *, off_t ofs, size_t read_bytes);
+bool textcache_put (void *kpage);
+int textcache_ref_cnt (void *kpage);
+
+#endif /* userprog/textcache.h */
@@ -2,6 +2,8 @@
 #include <debug.h>
 #include <stddef.h>
 #include "userprog/gdt.h"
+#include "userprog/syscall.h"
+#include "threads/cpu.h"
 #include "threads/thread.h"
 #include "threads/palloc.h"
 #include "threads/vaddr.h"
@@ -75,6 +77,23 @@ struct tss
 /* Kernel TSS. */
 static struct tss *tss;
 
+/* Stack that SYSENTER switches to.  Its top word is a copy of
+   tss->esp0, from which sysenter_entry loads the real kernel
+   stack pointer.  The rest is room for the debug trap that a
+   user program can raise on sysenter_entry's first instruction
+   (see debug() in exception.c). */
+#define SYSENTER_STACK_WORDS 256
+static uint32_t sysenter_stack[SYSENTER_STACK_WORDS];
+
+/* Model-specific registers read by SYSENTER.  See [IA32-v3a]
+   4.8.7 "Performing Fast Calls to System Procedures with the
+   SYSENTER and SYSEXIT Instructions". */
+#define MSR_SYSENTER_CS  0x174  /* Kernel code selector. */
+#define MSR_SYSENTER_ESP 0x175  /* Kernel stack pointer. */
+#define MSR_SYSENTER_EIP 0x176  /* Kernel entry point. */
+
+static bool sysenter_supported (void);
+
 /* Initializes the kernel TSS. */
 void
 tss_init (void) 
@@ -86,6 +105,35 @@ tss_init (void)
   tss->ss0 = SEL_KDSEG;
   tss->bitmap = 0xdfff;
   tss_update ();
+
+  /* Set up the SYSENTER fast system call path.  The stack pointer
+     SYSENTER loads is the top of sysenter_stack, not esp0, which
+     changes at every thread switch; sysenter_entry loads the real
+     stack pointer from there. */
+  if (sysenter_supported ()) 
+    {
+      wrmsr (MSR_SYSENTER_CS, SEL_KCSEG);
+      wrmsr (MSR_SYSENTER_ESP,
+             (uint32_t) &sysenter_stack[SYSENTER_STACK_WORDS - 1]);
+      wrmsr (MSR_SYSENTER_EIP, (uint32_t) sysenter_entry);
+    }
+}
+
+/* Returns true if the CPU has SYSENTER and SYSEXIT.  Early
+   Pentium Pros claim to have them but do not. */
+static bool
+sysenter_supported (void) 
+{
+  uint32_t regs[4];
+  unsigned family, model, stepping;
+
+  cpuid (1, regs);
+  family = (regs[0] >> 8) & 0xf;
+  model = (regs[0] >> 4) & 0xf;
+  stepping = regs[0] & 0xf;
+  if (family == 6 && model < 3 && stepping < 3)
+    return false;
+  return (regs[3] & (1 << 11)) != 0;
 }
 
 /* Returns the kernel TSS. */
@@ -103,4 +151,5 @@ tss_update (void)
 {
   ASSERT (tss != NULL);
   tss->esp0 = (uint8_t *) thread_current () + PGSIZE;
+  sysenter_stack[SYSENTER_STACK_WORDS - 1] = (uint32_t) tss->esp0;
 }
@@ -0,0 +1,123 @@
+#include "userprog/usercopy.h"
+#include <stdint.h>
+#include <string.h>
+#include "userprog/pagedir.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+
+#ifdef VM
+/* Reads a byte at user virtual address UADDR.
+   UADDR must be below PHYS_BASE.
+   Returns the byte value if successful, -1 if a segfault
+   occurred. */
+static int
+get_user (const uint8_t *uaddr)
+{
+  int result;
+  asm ("movl $1f, %0; movzbl %1, %0; 1:"
+       : "=&a" (result) : "m" (*uaddr));
+  return result;
+}
+#endif
+
+/* Returns true if UPAGE is a user page of the current process
+   that may be read, and if WRITE is true also written. */
+static bool
+page_ok (const void *upage, bool write)
+{
+  uint32_t *pd = thread_current ()->pagedir;
+
+  if (!is_user_vaddr (upage))
+    return false;
+  if (pagedir_get_page (pd, upage) == NULL) 
+    {
+#ifdef VM
+      /* Not present yet.  Touch it, so that the page fault
+         handler loads it or kills us. */
+      if (get_user (upage) == -1)
+        return false;
+#else
+      return false;
+#endif
+    }
+  return !write || pagedir_is_writable (pd, upage);
+}
+
+/* Returns true if the SIZE bytes starting at user address UADDR
+   may all be read, and if WRITE is true also written.  Each page
+   in the range is checked once. */
+bool
+user_access_ok (const void *uaddr, size_t size, bool write) 
+{
+  const uint8_t *start = uaddr;
+  const uint8_t *page;
+
+  if (size == 0)
+    return true;
+  if (start + size < start || !is_user_vaddr (start + size - 1))
+    return false;
+
+  for (page = pg_round_down (start); page <= start + size - 1;
+       page += PGSIZE)
+    if (!page_ok (page, write))
+      return false;
+  return true;
+}
+
+/* Copies SIZE bytes from user address USRC to kernel address
+   DST.  Returns true if successful, false if USRC is not
+   readable. */
+bool
+copy_from_user (void *dst, const void *usrc, size_t size) 
+{
+  if (!user_access_ok (usrc, size, false))
+    return false;
+  memcpy (dst, usrc, size);
+  return true;
+}
+
+/* Copies SIZE bytes from kernel address SRC to user address
+   UDST.  Returns true if successful, false if UDST is not
+   writable. */
+bool
+copy_to_user (void *udst, const void *src, size_t size) 
+{
+  if (!user_access_ok (udst, size, true))
+    return false;
+  memcpy (udst, src, size);
+  return true;
+}
+
+/* Copies the null-terminated string at user address USRC into
+   DST, which has room for SIZE bytes, a page at a time.  Pages
+   after the one holding the null terminator are not touched.
+   Returns the length of the string, SIZE if no null terminator
+   was found in the first SIZE bytes (DST is then not
+   null-terminated), or -1 if USRC is not readable. */
+int
+strncpy_from_user (char *dst, const char *usrc, size_t size) 
+{
+  size_t copied = 0;
+
+  while (copied < size) 
+    {
+      const char *src = usrc + copied;
+      size_t chunk = PGSIZE - pg_ofs (src);
+      const char *nul;
+
+      if (chunk > size - copied)
+        chunk = size - copied;
+      if (!page_ok (pg_round_down (src), false))
+        return -1;
+
+      nul = memchr (src, '\0', chunk);
+      if (nul != NULL) 
+        {
+          memcpy (dst + copied, src, nul - src + 1);
+          return copied + (nul - src);
+        }
+      memcpy (dst + copied, src, chunk);
+      copied += chunk;
+    }
+  return size;
+}
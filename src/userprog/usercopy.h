@@ -0,0 +1,21 @@
+#ifndef USERPROG_USERCOPY_H
+#define USERPROG_USERCOPY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Access to user memory from system calls.
+
+   Each function checks every user page it touches once, up
+   front, and then copies whole runs at once with memcpy().
+   They return false (or -1) if any page is not a mapped user
+   page, or, when writing, not a writable one.  A page that is
+   mapped but not yet loaded is brought in by touching it, so
+   that the page fault handler can load it or kill the
+   process. */
+bool user_access_ok (const void *uaddr, size_t size, bool write);
+bool copy_from_user (void *dst, const void *usrc, size_t size);
+bool copy_to_user (void *udst, const void *src, size_t size);
+int strncpy_from_user (char *dst, const char *usrc, size_t size);
+
+#endif /* userprog/usercopy.h */
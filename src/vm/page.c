@@ -1,4 +1,14 @@
 #include "vm/page.h"
+#include <stdio.h>
+#include <string.h>
+#include "filesys/file.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "userprog/pagedir.h"
+#include "userprog/textcache.h"
+
+/* Number of pages loaded on first touch. */
+static long long page_load_cnt;
 
 /* Hash function for supplemental page table. */
 unsigned 
@@ -24,15 +34,87 @@ init_supPT(struct hash *supPT)
   hash_init(supPT, sup_hash, sup_less, NULL);
 }
 
+/* Frees supplemental page table entry E. */
+static void
+free_supPTE(struct hash_elem *e, void *aux UNUSED)
+{
+  free(hash_entry(e, struct supPTE, elem));
+}
+
+/* Destroy supplemental page table, freeing its entries.
+   Pages already loaded belong to the page directory. */
 void
 destroy_supPT(struct hash *supPT)
 {
-  /* Not implemented yet. */
+  hash_destroy(supPT, free_supPTE);
 }
 
+/* Records that page UVA of the current process is to be loaded,
+   on first touch, from READ_BYTES bytes at offset OFS in FILE
+   followed by zeros.  Returns false if memory is short or UVA
+   already has an entry. */
+bool
+add_supPTE(struct file *file, off_t ofs, void *uva,
+		   uint32_t read_bytes, bool writable)
+{
+  struct supPTE *entry = malloc(sizeof *entry);
+
+  if(!entry) return false;
+
+  entry->uva = uva;
+  entry->writable = writable;
+  entry->file = file;
+  entry->ofs = ofs;
+  entry->read_bytes = read_bytes;
+
+  if(hash_insert(&thread_current()->supPT, &entry->elem)){
+	free(entry);
+	return false;
+  }
+  return true;
+}
+
+/* Loads the page described by ENTRY and maps it into the current
+   process.  Read-only pages come from the shared text cache.
+   Returns true if successful. */
 bool
 load_page(struct supPTE *entry)
 {
+  uint32_t *pd = thread_current()->pagedir;
+  uint8_t *kpage;
+
+  if(!entry->writable){
+	kpage = textcache_get(entry->file, entry->ofs, entry->read_bytes);
+	if(!kpage) return false;
+	if(!pagedir_set_page(pd, entry->uva, kpage, false)){
+	  textcache_put(kpage);
+	  return false;
+	}
+  }
+  else{
+	kpage = palloc_get_page(PAL_USER);
+	if(!kpage) return false;
+	if(file_read_at(entry->file, kpage, entry->read_bytes, entry->ofs)
+	   != (off_t)entry->read_bytes){
+	  palloc_free_page(kpage);
+	  return false;
+	}
+	memset(kpage + entry->read_bytes, 0, PGSIZE - entry->read_bytes);
+	if(!pagedir_set_page(pd, entry->uva, kpage, true)){
+	  palloc_free_page(kpage);
+	  return false;
+	}
+  }
+
+  page_load_cnt++;
+  return true;
+}
+
+/* Prints paging statistics. */
+void
+print_page_stats(void)
+{
+  printf("Paging: %lld pages loaded on demand\n", page_load_cnt);
 }
 
 /* Returns pointer of entry of supplemental page table 
@@ -2,6 +2,7 @@
 #define VM_PAGE_H
 
 #include <hash.h>
+#include "filesys/off_t.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"
 
@@ -14,6 +15,12 @@ struct supPTE
 	 False otherwise. */
   bool writable;
 
+  /* Where the page's contents come from: READ_BYTES bytes
+	 at offset OFS in FILE, then zeros to the end of the page. */
+  struct file *file;
+  off_t ofs;
+  uint32_t read_bytes;
+
   /* For supplemental page table. */
   struct hash_elem elem;
 };
@@ -26,7 +33,10 @@ bool sup_less (const struct hash_elem *a,
 void init_supPT(struct hash *supPT);
 void destroy_supPT(struct hash *supPT);
 
+bool add_supPTE(struct file *file, off_t ofs, void *uva,
+				uint32_t read_bytes, bool writable);
 bool load_page(struct supPTE *entry);
+void print_page_stats(void);
 
 struct supPTE* get_supPTE(void *uva);
 